@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Automata de Aho-Corasick: cuenta (con solapamiento) las ocurrencias de
+// todos los patrones en una sola pasada sobre el texto, en lugar de recorrer
+// el texto una vez por patron.
+//
+// - Los patrones repetidos se deduplican: cada patron distinto tiene un unico
+//   estado final y los indices originales se mapean a el.
+// - Los bytes que no aparecen en ningun patron comparten una misma clase, asi
+//   la tabla de transiciones es un arreglo contiguo (estados x clases) chico.
+// - Durante el recorrido solo se incrementa un contador de visitas por estado;
+//   los conteos por patron se obtienen al final propagando las visitas por los
+//   enlaces de falla (en orden BFS inverso).
+class AhoCorasick {
+public:
+    explicit AhoCorasick(const std::vector<std::string>& patrones) {
+        clase_.fill(0);
+        for (const auto& p : patrones)
+            for (unsigned char c : p)
+                if (clase_[c] == 0) clase_[c] = static_cast<uint8_t>(++num_clases_ - 1);
+
+        // Trie: el estado 0 es la raiz; una transicion en 0 significa "sin hijo"
+        // (ningun arco del trie vuelve a la raiz).
+        transiciones_.assign(num_clases_, 0);
+        std::unordered_map<std::string, uint32_t> unicos;
+        patron_a_unico_.reserve(patrones.size());
+        for (const auto& p : patrones) {
+            auto it = unicos.find(p);
+            if (it == unicos.end()) {
+                it = unicos.emplace(p, static_cast<uint32_t>(terminal_unico_.size())).first;
+                terminal_unico_.push_back(insertar(p));
+                if (p.size() > long_max_) long_max_ = p.size();
+            }
+            patron_a_unico_.push_back(it->second);
+        }
+
+        // BFS: enlaces de falla y completado de la tabla (automata determinista).
+        const uint32_t estados = cantidad_estados();
+        falla_.assign(estados, 0);
+        orden_bfs_.reserve(estados);
+        orden_bfs_.push_back(0);
+        for (size_t i = 0; i < orden_bfs_.size(); i++) {
+            uint32_t s = orden_bfs_[i];
+            for (uint32_t c = 0; c < num_clases_; c++) {
+                uint32_t& t = transiciones_[size_t(s) * num_clases_ + c];
+                uint32_t destino_falla = (s == 0) ? 0 : transiciones_[size_t(falla_[s]) * num_clases_ + c];
+                if (t != 0) {
+                    falla_[t] = destino_falla;
+                    orden_bfs_.push_back(t);
+                } else {
+                    t = destino_falla;
+                }
+            }
+        }
+    }
+
+    // Cantidad de ocurrencias de cada patron, en el orden en que se recibieron.
+    std::vector<size_t> contar(std::string_view texto) const {
+        std::vector<uint64_t> visitas(cantidad_estados(), 0);
+        avanzar(estado_inicial(), texto, visitas);
+        return conteos_desde_visitas(visitas);
+    }
+
+    // Primitivas para recorridos por bloques o en streaming: `avanzar` consume
+    // `bloque` desde `estado`, acumula en `visitas` (tamanio cantidad_estados())
+    // y devuelve el estado final para continuar con el bloque siguiente.
+    uint32_t estado_inicial() const { return 0; }
+
+    uint32_t avanzar(uint32_t estado, std::string_view bloque, std::vector<uint64_t>& visitas) const {
+        const uint32_t* tabla = transiciones_.data();
+        const uint32_t nc = num_clases_;
+        uint64_t* v = visitas.data();
+        for (unsigned char c : bloque) {
+            estado = tabla[size_t(estado) * nc + clase_[c]];
+            v[estado]++;
+        }
+        return estado;
+    }
+
+    // Igual que `avanzar` pero sin contar: sirve para sincronizar el estado
+    // sobre el solapamiento previo a un bloque.
+    uint32_t recorrer(uint32_t estado, std::string_view bloque) const {
+        const uint32_t* tabla = transiciones_.data();
+        const uint32_t nc = num_clases_;
+        for (unsigned char c : bloque) estado = tabla[size_t(estado) * nc + clase_[c]];
+        return estado;
+    }
+
+    std::vector<size_t> conteos_desde_visitas(const std::vector<uint64_t>& visitas) const {
+        std::vector<uint64_t> total(visitas);
+        for (size_t i = orden_bfs_.size(); i-- > 1;) {
+            uint32_t s = orden_bfs_[i];
+            total[falla_[s]] += total[s];
+        }
+        std::vector<size_t> conteos(patron_a_unico_.size(), 0);
+        for (size_t i = 0; i < patron_a_unico_.size(); i++) {
+            uint32_t estado = terminal_unico_[patron_a_unico_[i]];
+            if (estado != 0) conteos[i] = total[estado]; // el patron vacio no cuenta
+        }
+        return conteos;
+    }
+
+    uint32_t cantidad_estados() const { return static_cast<uint32_t>(transiciones_.size() / num_clases_); }
+    size_t longitud_maxima() const { return long_max_; }
+    size_t cantidad_patrones_unicos() const { return terminal_unico_.size(); }
+
+private:
+    uint32_t insertar(const std::string& patron) {
+        uint32_t s = 0;
+        for (unsigned char c : patron) {
+            size_t pos = size_t(s) * num_clases_ + clase_[c];
+            if (transiciones_[pos] == 0) {
+                uint32_t nuevo = cantidad_estados();
+                transiciones_.resize(transiciones_.size() + num_clases_, 0);
+                transiciones_[pos] = nuevo;
+            }
+            s = transiciones_[pos];
+        }
+        return s;
+    }
+
+    std::array<uint8_t, 256> clase_;        // byte -> clase (0 = no aparece en patrones)
+    uint32_t num_clases_ = 1;
+    std::vector<uint32_t> transiciones_;    // estados x num_clases_, row-major
+    std::vector<uint32_t> falla_;
+    std::vector<uint32_t> orden_bfs_;
+    std::vector<uint32_t> terminal_unico_;  // estado final de cada patron distinto
+    std::vector<uint32_t> patron_a_unico_;  // indice original -> patron distinto
+    size_t long_max_ = 0;
+};
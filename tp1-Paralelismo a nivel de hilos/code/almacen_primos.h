@@ -0,0 +1,392 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "criba_segmentada.h"
+#include "pool_hilos.h"
+
+// Representaciones compactas de los primos en [2, N], alternativas a
+// vector<long long> (8 bytes por primo):
+//
+//  - PrimosConteo: solo la cantidad y los ultimos k primos.
+//  - PrimosBitset: un bit por impar (N/16 bytes), con conteo por segmento.
+//  - PrimosDelta:  diferencias entre primos consecutivos / 2 codificadas como
+//                  varint (~1 byte por primo) mas un indice por segmento para
+//                  acceso aleatorio.
+//
+// Las tres se generan segmento por segmento desde CribaSegmentada; con un pool
+// los segmentos se reparten dinamicamente entre sus hilos (pool == nullptr: en
+// el hilo actual).
+// Bitset y Delta exponen un iterador de entrada para recorrer los primos.
+
+// Tiempo ocupado y segmentos procesados por cada trabajador, para ver el
+// desbalance de carga de una corrida paralela.
+struct CargaTrabajadores {
+    std::vector<double> ocupado;      // segundos
+    std::vector<uint64_t> segmentos;
+
+    void preparar(size_t trabajadores) {
+        if (ocupado.size() < trabajadores) {
+            ocupado.resize(trabajadores, 0.0);
+            segmentos.resize(trabajadores, 0);
+        }
+    }
+
+    // max / promedio del tiempo ocupado (1 = perfectamente balanceado).
+    double desbalance() const {
+        double maximo = 0.0, suma = 0.0;
+        for (double t : ocupado) { maximo = std::max(maximo, t); suma += t; }
+        return suma > 0.0 ? maximo * double(ocupado.size()) / suma : 1.0;
+    }
+
+    void mostrar(std::ostream& os) const {
+        for (size_t t = 0; t < ocupado.size(); t++)
+            os << "  trabajador " << t << ": " << ocupado[t] << " s ocupado, " << segmentos[t] << " segmentos\n";
+        os << "  desbalance (max/promedio): " << desbalance() << "\n";
+    }
+};
+
+// Reparto dinamico: cada trabajador del pool toma el siguiente segmento de un
+// contador atomico hasta agotarlos, asi los que terminan antes siguen tomando
+// trabajo en lugar de esperar al mas lento. cuerpo(s, s + 1) procesa un
+// segmento; con pool == nullptr se llama una sola vez con todo el rango.
+template <class F>
+void para_cada_segmento(uint64_t segmentos, PoolHilos* pool, F&& cuerpo, CargaTrabajadores* carga = nullptr) {
+    using reloj = std::chrono::steady_clock;
+    if (!pool) {
+        auto t0 = reloj::now();
+        cuerpo(size_t(0), size_t(segmentos));
+        if (carga) {
+            carga->preparar(1);
+            carga->ocupado[0] += std::chrono::duration<double>(reloj::now() - t0).count();
+            carga->segmentos[0] += segmentos;
+        }
+        return;
+    }
+    const size_t trabajadores = pool->cantidad_hilos();
+    if (carga) carga->preparar(trabajadores);
+    std::atomic<uint64_t> siguiente{0};
+    pool->parallel_for(0, trabajadores, 1, [&](size_t t, size_t) {
+        auto t0 = reloj::now();
+        uint64_t hechos = 0;
+        for (uint64_t s; (s = siguiente.fetch_add(1, std::memory_order_relaxed)) < segmentos; hechos++)
+            cuerpo(size_t(s), size_t(s + 1));
+        if (carga) {
+            carga->ocupado[t] += std::chrono::duration<double>(reloj::now() - t0).count();
+            carga->segmentos[t] += hechos;
+        }
+    });
+}
+
+// Los k primos mas grandes, recorriendo los segmentos desde el final.
+inline std::vector<uint64_t> ultimos_primos(const CribaSegmentada& criba, size_t k) {
+    std::vector<uint64_t> ultimos, bits;
+    for (uint64_t s = criba.cantidad_segmentos(); s-- > 0 && ultimos.size() < k;) {
+        std::vector<uint64_t> segmento;
+        criba.recorrer_segmento(s, bits, [&](uint64_t p) { segmento.push_back(p); });
+        ultimos.insert(ultimos.begin(), segmento.begin(), segmento.end());
+    }
+    if (ultimos.size() > k) ultimos.erase(ultimos.begin(), ultimos.end() - k);
+    return ultimos;
+}
+
+// --------------------
+// Solo conteo
+// --------------------
+class PrimosConteo {
+public:
+    static PrimosConteo generar(const CribaSegmentada& criba, PoolHilos* pool, CargaTrabajadores* carga = nullptr,
+                               size_t guardar_ultimos = 10) {
+        PrimosConteo r;
+        std::vector<uint64_t> conteos(criba.cantidad_segmentos());
+        para_cada_segmento(conteos.size(), pool, [&](size_t ini, size_t fin) {
+            std::vector<uint64_t> bits;
+            for (size_t s = ini; s < fin; s++) conteos[s] = criba.contar_segmento(s, bits);
+        }, carga);
+        for (uint64_t c : conteos) r.cantidad_ += c;
+        r.ultimos_ = ultimos_primos(criba, guardar_ultimos);
+        return r;
+    }
+
+    uint64_t size() const { return cantidad_; }
+    std::vector<uint64_t> ultimos(size_t k) const {
+        k = std::min(k, ultimos_.size());
+        return std::vector<uint64_t>(ultimos_.end() - k, ultimos_.end());
+    }
+    size_t bytes() const { return ultimos_.size() * sizeof(uint64_t); }
+
+private:
+    uint64_t cantidad_ = 0;
+    std::vector<uint64_t> ultimos_;
+};
+
+// --------------------
+// Bitset de impares
+// --------------------
+class PrimosBitset {
+public:
+    static PrimosBitset generar(const CribaSegmentada& criba, PoolHilos* pool, CargaTrabajadores* carga = nullptr) {
+        constexpr uint64_t PALABRAS = CribaSegmentada::BITS_SEGMENTO / 64;
+        PrimosBitset r;
+        r.incluye_dos_ = criba.limite() >= 2;
+        r.palabras_.resize(criba.cantidad_segmentos() * PALABRAS);
+        r.antes_de_segmento_.resize(criba.cantidad_segmentos() + 1, 0);
+        para_cada_segmento(criba.cantidad_segmentos(), pool, [&](size_t ini, size_t fin) {
+            std::vector<uint64_t> bits;
+            for (size_t s = ini; s < fin; s++) {
+                criba.cribar(s, bits);
+                uint64_t cuenta = 0;
+                for (uint64_t w = 0; w < PALABRAS; w++) {
+                    r.palabras_[s * PALABRAS + w] = bits[w];
+                    cuenta += uint64_t(__builtin_popcountll(bits[w]));
+                }
+                r.antes_de_segmento_[s + 1] = cuenta;
+            }
+        }, carga);
+        for (size_t s = 1; s < r.antes_de_segmento_.size(); s++) r.antes_de_segmento_[s] += r.antes_de_segmento_[s - 1];
+        return r;
+    }
+
+    uint64_t size() const { return antes_de_segmento_.back() + (incluye_dos_ ? 1 : 0); }
+    size_t bytes() const { return palabras_.size() * sizeof(uint64_t) + antes_de_segmento_.size() * sizeof(uint64_t); }
+
+    bool contiene(uint64_t n) const {
+        if (n == 2) return incluye_dos_;
+        if (n % 2 == 0) return false;
+        uint64_t j = n / 2;
+        return j / 64 < palabras_.size() && (palabras_[j / 64] >> (j % 64)) & 1;
+    }
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = uint64_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const uint64_t*;
+        using reference = uint64_t;
+
+        iterator(const PrimosBitset* b, bool fin) : b_(b), w_(fin ? b->palabras_.size() : 0) {
+            if (!fin && b->incluye_dos_) { actual_ = 2; dos_pendiente_ = true; return; }
+            if (!fin) { resto_ = b->palabras_.empty() ? 0 : b->palabras_[0]; avanzar(); }
+        }
+        uint64_t operator*() const { return actual_; }
+        iterator& operator++() {
+            if (dos_pendiente_) {
+                dos_pendiente_ = false;
+                resto_ = b_->palabras_.empty() ? 0 : b_->palabras_[0];
+            }
+            avanzar();
+            return *this;
+        }
+        bool operator==(const iterator& o) const { return w_ == o.w_ && resto_ == o.resto_ && dos_pendiente_ == o.dos_pendiente_; }
+        bool operator!=(const iterator& o) const { return !(*this == o); }
+
+    private:
+        void avanzar() {
+            while (resto_ == 0) {
+                if (++w_ >= b_->palabras_.size()) { w_ = b_->palabras_.size(); return; }
+                resto_ = b_->palabras_[w_];
+            }
+            actual_ = 2 * (w_ * 64 + uint64_t(__builtin_ctzll(resto_))) + 1;
+            resto_ &= resto_ - 1;
+        }
+        const PrimosBitset* b_;
+        size_t w_;
+        uint64_t resto_ = 0;
+        uint64_t actual_ = 0;
+        bool dos_pendiente_ = false;
+    };
+
+    iterator begin() const { return iterator(this, false); }
+    iterator end() const { return iterator(this, true); }
+
+    std::vector<uint64_t> ultimos(size_t k) const {
+        std::vector<uint64_t> r;
+        for (size_t w = palabras_.size(); w-- > 0 && r.size() < k;) {
+            uint64_t palabra = palabras_[w];
+            while (palabra && r.size() < k) {
+                int bit = 63 - __builtin_clzll(palabra);
+                r.push_back(2 * (w * 64 + uint64_t(bit)) + 1);
+                palabra &= ~(uint64_t(1) << bit);
+            }
+        }
+        if (r.size() < k && incluye_dos_) r.push_back(2);
+        std::reverse(r.begin(), r.end());
+        return r;
+    }
+
+private:
+    bool incluye_dos_ = false;
+    std::vector<uint64_t> palabras_;          // bit j <-> 2j + 1
+    std::vector<uint64_t> antes_de_segmento_; // primos impares en segmentos anteriores
+};
+
+// --------------------
+// Diferencias codificadas como varint
+// --------------------
+class PrimosDelta {
+public:
+    static PrimosDelta generar(const CribaSegmentada& criba, PoolHilos* pool, CargaTrabajadores* carga = nullptr) {
+        const uint64_t segmentos = criba.cantidad_segmentos();
+        PrimosDelta r;
+        r.incluye_dos_ = criba.limite() >= 2;
+        r.indice_.resize(segmentos + 1);
+
+        // Fase 1: bytes y primos por segmento. Fase 2: suma prefija y escritura
+        // directa en el buffer final (mismo esquema que primosParalelo).
+        std::vector<uint64_t> bytes_seg(segmentos), primos_seg(segmentos);
+        para_cada_segmento(segmentos, pool, [&](size_t ini, size_t fin) {
+            std::vector<uint64_t> bits;
+            for (size_t s = ini; s < fin; s++) {
+                uint64_t previo = s * CribaSegmentada::NUMEROS_POR_SEGMENTO + 1, total = 0, cuenta = 0;
+                criba.recorrer_segmento(s, bits, [&](uint64_t p) {
+                    if (p == 2) return;
+                    total += largo_varint((p - previo) / 2);
+                    cuenta++;
+                    previo = p;
+                });
+                bytes_seg[s] = total;
+                primos_seg[s] = cuenta;
+            }
+        }, carga);
+        for (uint64_t s = 0; s < segmentos; s++) {
+            r.indice_[s + 1].desplazamiento = r.indice_[s].desplazamiento + bytes_seg[s];
+            r.indice_[s + 1].primos_antes = r.indice_[s].primos_antes + primos_seg[s];
+        }
+        r.datos_.resize(r.indice_[segmentos].desplazamiento);
+        para_cada_segmento(segmentos, pool, [&](size_t ini, size_t fin) {
+            std::vector<uint64_t> bits;
+            for (size_t s = ini; s < fin; s++) {
+                uint8_t* destino = r.datos_.data() + r.indice_[s].desplazamiento;
+                uint64_t previo = s * CribaSegmentada::NUMEROS_POR_SEGMENTO + 1;
+                criba.recorrer_segmento(s, bits, [&](uint64_t p) {
+                    if (p == 2) return;
+                    destino = escribir_varint(destino, (p - previo) / 2);
+                    previo = p;
+                });
+            }
+        }, carga);
+        return r;
+    }
+
+    uint64_t size() const { return indice_.back().primos_antes + (incluye_dos_ ? 1 : 0); }
+    size_t bytes() const { return datos_.size() + indice_.size() * sizeof(Entrada); }
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = uint64_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const uint64_t*;
+        using reference = uint64_t;
+
+        // Posiciona en el i-esimo primo impar (0-based); `dos` antepone el 2.
+        iterator(const PrimosDelta* d, uint64_t i, bool dos) : d_(d), i_(i), dos_(dos) {
+            if (dos_ || i_ >= total()) return;
+            // segmento que contiene al primo i: ultimo con primos_antes <= i
+            auto it = std::upper_bound(d_->indice_.begin(), d_->indice_.end() - 1, i_,
+                                       [](uint64_t v, const Entrada& e) { return v < e.primos_antes; });
+            seg_ = uint64_t(it - d_->indice_.begin()) - 1;
+            entrar_segmento();
+            for (uint64_t k = d_->indice_[seg_].primos_antes; k <= i_; k++) leer_siguiente();
+        }
+        uint64_t operator*() const { return dos_ ? 2 : actual_; }
+        iterator& operator++() {
+            if (dos_) {
+                dos_ = false;
+                *this = iterator(d_, i_, false);
+                return *this;
+            }
+            if (++i_ >= total()) return *this;
+            while (i_ >= d_->indice_[seg_ + 1].primos_antes) { seg_++; entrar_segmento(); }
+            leer_siguiente();
+            return *this;
+        }
+        bool operator==(const iterator& o) const { return i_ == o.i_ && dos_ == o.dos_; }
+        bool operator!=(const iterator& o) const { return !(*this == o); }
+
+    private:
+        uint64_t total() const { return d_->indice_.back().primos_antes; }
+        void entrar_segmento() {
+            pos_ = d_->datos_.data() + d_->indice_[seg_].desplazamiento;
+            actual_ = seg_ * CribaSegmentada::NUMEROS_POR_SEGMENTO + 1;
+        }
+        void leer_siguiente() {
+            uint64_t v = 0;
+            for (int corrimiento = 0;; corrimiento += 7) {
+                uint8_t b = *pos_++;
+                v |= uint64_t(b & 0x7f) << corrimiento;
+                if (!(b & 0x80)) break;
+            }
+            actual_ += 2 * v;
+        }
+        const PrimosDelta* d_;
+        uint64_t i_;
+        bool dos_;
+        uint64_t seg_ = 0;
+        const uint8_t* pos_ = nullptr;
+        uint64_t actual_ = 0;
+    };
+
+    iterator begin() const { return iterator(this, 0, incluye_dos_); }
+    iterator end() const { return iterator(this, indice_.back().primos_antes, false); }
+
+    // Acceso aleatorio: el i-esimo primo (0-based), decodificando desde el
+    // inicio de su segmento.
+    uint64_t en(uint64_t i) const { return *desde(i); }
+    iterator desde(uint64_t i) const {
+        if (incluye_dos_) {
+            if (i == 0) return begin();
+            i--;
+        }
+        return iterator(this, i, false);
+    }
+
+    std::vector<uint64_t> ultimos(size_t k) const {
+        uint64_t n = size(), ini = n > k ? n - k : 0;
+        std::vector<uint64_t> r;
+        for (auto it = desde(ini); it != end(); ++it) r.push_back(*it);
+        return r;
+    }
+
+private:
+    struct Entrada {
+        uint64_t desplazamiento = 0; // primer byte del segmento en datos_
+        uint64_t primos_antes = 0;   // primos impares en segmentos anteriores
+    };
+
+    static uint64_t largo_varint(uint64_t v) {
+        uint64_t largo = 1;
+        while (v >= 0x80) { v >>= 7; largo++; }
+        return largo;
+    }
+    static uint8_t* escribir_varint(uint8_t* destino, uint64_t v) {
+        while (v >= 0x80) { *destino++ = uint8_t(v | 0x80); v >>= 7; }
+        *destino++ = uint8_t(v);
+        return destino;
+    }
+
+    bool incluye_dos_ = false;
+    std::vector<uint8_t> datos_;
+    std::vector<Entrada> indice_;
+};
+
+// Formato de salida elegido con --formato=
+enum class FormatoPrimos { Vector, Conteo, Bitset, Delta };
+
+inline bool parsear_formato(const std::string& texto, FormatoPrimos& formato) {
+    if (texto == "vector") formato = FormatoPrimos::Vector;
+    else if (texto == "conteo") formato = FormatoPrimos::Conteo;
+    else if (texto == "bitset") formato = FormatoPrimos::Bitset;
+    else if (texto == "delta") formato = FormatoPrimos::Delta;
+    else return false;
+    return true;
+}
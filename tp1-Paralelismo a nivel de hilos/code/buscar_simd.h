@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+#include <immintrin.h>
+
+// Conteo de ocurrencias (con solapamiento) de un unico patron.
+//
+// Filtro de primer y ultimo byte: por cada bloque de 32 (AVX2) o 16 (SSE2)
+// posiciones se compara el texto contra el primer byte del patron y, corrido
+// m-1 lugares, contra el ultimo. Solo las posiciones donde coinciden ambos se
+// verifican con memcmp. Como se evalua cada posicion, las ocurrencias
+// solapadas se cuentan igual que avanzando de a un byte con find.
+//
+// La variante se elige una sola vez en tiempo de ejecucion segun la CPU
+// (AVX2 -> SSE2 -> escalar).
+
+namespace buscar_simd {
+
+inline size_t contar_escalar(const char* t, size_t n, const char* p, size_t m, size_t desde) {
+    size_t cuenta = 0;
+    const char primero = p[0];
+    for (size_t i = desde; i + m <= n;) {
+        const void* hit = std::memchr(t + i, primero, n - m + 1 - i);
+        if (!hit) break;
+        i = size_t(static_cast<const char*>(hit) - t);
+        if (std::memcmp(t + i + 1, p + 1, m - 1) == 0) cuenta++;
+        i++;
+    }
+    return cuenta;
+}
+
+__attribute__((target("avx2")))
+inline size_t contar_avx2(const char* t, size_t n, const char* p, size_t m) {
+    const __m256i primero = _mm256_set1_epi8(p[0]);
+    const __m256i ultimo = _mm256_set1_epi8(p[m - 1]);
+    size_t cuenta = 0;
+    size_t i = 0;
+    for (; i + m - 1 + 32 <= n; i += 32) {
+        __m256i bloque_ini = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t + i));
+        __m256i bloque_fin = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t + i + m - 1));
+        unsigned mascara = unsigned(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(bloque_ini, primero), _mm256_cmpeq_epi8(bloque_fin, ultimo))));
+        if (m <= 2) {
+            cuenta += size_t(__builtin_popcount(mascara));
+            continue;
+        }
+        while (mascara) {
+            unsigned bit = unsigned(__builtin_ctz(mascara));
+            if (std::memcmp(t + i + bit + 1, p + 1, m - 2) == 0) cuenta++;
+            mascara &= mascara - 1;
+        }
+    }
+    return cuenta + contar_escalar(t, n, p, m, i);
+}
+
+__attribute__((target("sse2")))
+inline size_t contar_sse2(const char* t, size_t n, const char* p, size_t m) {
+    const __m128i primero = _mm_set1_epi8(p[0]);
+    const __m128i ultimo = _mm_set1_epi8(p[m - 1]);
+    size_t cuenta = 0;
+    size_t i = 0;
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        __m128i bloque_ini = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t + i));
+        __m128i bloque_fin = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t + i + m - 1));
+        unsigned mascara = unsigned(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(bloque_ini, primero), _mm_cmpeq_epi8(bloque_fin, ultimo))));
+        if (m <= 2) {
+            cuenta += size_t(__builtin_popcount(mascara));
+            continue;
+        }
+        while (mascara) {
+            unsigned bit = unsigned(__builtin_ctz(mascara));
+            if (std::memcmp(t + i + bit + 1, p + 1, m - 2) == 0) cuenta++;
+            mascara &= mascara - 1;
+        }
+    }
+    return cuenta + contar_escalar(t, n, p, m, i);
+}
+
+using Kernel = size_t (*)(const char*, size_t, const char*, size_t);
+
+inline size_t contar_solo_escalar(const char* t, size_t n, const char* p, size_t m) {
+    return contar_escalar(t, n, p, m, 0);
+}
+
+inline Kernel elegir_kernel() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return contar_avx2;
+    if (__builtin_cpu_supports("sse2")) return contar_sse2;
+    return contar_solo_escalar;
+}
+
+inline const char* nombre_kernel() {
+    Kernel k = elegir_kernel();
+    return k == contar_avx2 ? "avx2" : k == contar_sse2 ? "sse2" : "escalar";
+}
+
+} // namespace buscar_simd
+
+inline size_t contar_ocurrencias_simd(std::string_view texto, std::string_view patron) {
+    static const buscar_simd::Kernel kernel = buscar_simd::elegir_kernel();
+    if (patron.empty() || patron.size() > texto.size()) return 0;
+    return kernel(texto.data(), texto.size(), patron.data(), patron.size());
+}
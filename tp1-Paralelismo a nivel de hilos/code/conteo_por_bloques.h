@@ -0,0 +1,38 @@
+#pragma once
+
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+#include "aho_corasick.h"
+#include "pool_hilos.h"
+
+// Conteo paralelo dividiendo el TEXTO (no los patrones) en bloques contiguos.
+// Cada bloque arranca el automata (longitud_maxima - 1) bytes antes de su
+// inicio para reconstruir el estado correcto, pero solo cuenta las coincidencias
+// que TERMINAN dentro del bloque; asi ninguna coincidencia del solapamiento se
+// cuenta dos veces. Las visitas por estado de cada bloque se suman al final.
+//
+// Se generan varios bloques por hilo del pool para que los que terminan antes
+// roben trabajo de los demas.
+inline std::vector<size_t> contar_por_bloques(const AhoCorasick& automata, std::string_view texto, PoolHilos& pool) {
+    const size_t n = texto.size();
+    const size_t solapamiento = automata.longitud_maxima() > 0 ? automata.longitud_maxima() - 1 : 0;
+    const size_t bloques = std::max<size_t>(1, std::min<size_t>(n, 4 * size_t(pool.cantidad_hilos())));
+    const size_t tam_bloque = (n + bloques - 1) / bloques;
+
+    std::vector<std::vector<uint64_t>> visitas(bloques, std::vector<uint64_t>(automata.cantidad_estados(), 0));
+    pool.parallel_for(0, bloques, 1, [&](size_t b0, size_t b1) {
+        for (size_t b = b0; b < b1; b++) {
+            size_t ini = std::min(n, b * tam_bloque);
+            size_t fin = std::min(n, ini + tam_bloque);
+            size_t previo = ini - std::min(ini, solapamiento);
+            uint32_t estado = automata.recorrer(automata.estado_inicial(), texto.substr(previo, ini - previo));
+            automata.avanzar(estado, texto.substr(ini, fin - ini), visitas[b]);
+        }
+    });
+
+    for (size_t b = 1; b < bloques; b++)
+        for (size_t s = 0; s < visitas[0].size(); s++) visitas[0][s] += visitas[b][s];
+    return automata.conteos_desde_visitas(visitas[0]);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+#include "aho_corasick.h"
+
+// Conteo de patrones sobre una entrada no acotada (stdin, pipes, logs mas
+// grandes que la memoria) usando un buffer de tamanio fijo.
+//
+// Entre un buffer y el siguiente no hace falta guardar los ultimos
+// (longitud_maxima - 1) bytes: el estado del automata ya resume exactamente
+// ese sufijo, asi que una coincidencia que cruza el borde se completa en el
+// buffer siguiente y se cuenta una sola vez. La memoria usada es el buffer
+// mas un contador por estado, independiente del tamanio de la entrada.
+class ContadorStreaming {
+public:
+    explicit ContadorStreaming(const AhoCorasick& automata)
+        : automata_(automata), estado_(automata.estado_inicial()),
+          visitas_(automata.cantidad_estados(), 0) {}
+
+    void consumir(std::string_view bloque) {
+        estado_ = automata_.avanzar(estado_, bloque, visitas_);
+        bytes_ += bloque.size();
+    }
+
+    std::vector<size_t> conteos() const { return automata_.conteos_desde_visitas(visitas_); }
+    uint64_t bytes_procesados() const { return bytes_; }
+
+private:
+    const AhoCorasick& automata_;
+    uint32_t estado_;
+    std::vector<uint64_t> visitas_;
+    uint64_t bytes_ = 0;
+};
+
+// Lee `fd` hasta EOF en bloques de `tam_buffer` bytes. Cada vez que se superan
+// `bytes_por_reporte` bytes desde el ultimo reporte llama a `reportar` con el
+// contador (para mostrar conteos parciales). Devuelve false si read falla.
+inline bool contar_streaming(int fd, ContadorStreaming& contador, size_t tam_buffer, uint64_t bytes_por_reporte,
+                             const std::function<void(const ContadorStreaming&)>& reportar) {
+    std::vector<char> buffer(tam_buffer);
+    uint64_t proximo_reporte = bytes_por_reporte;
+    for (;;) {
+        ssize_t leidos = ::read(fd, buffer.data(), buffer.size());
+        if (leidos < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (leidos == 0) return true;
+        contador.consumir(std::string_view(buffer.data(), size_t(leidos)));
+        if (bytes_por_reporte > 0 && contador.bytes_procesados() >= proximo_reporte) {
+            reportar(contador);
+            while (proximo_reporte <= contador.bytes_procesados()) proximo_reporte += bytes_por_reporte;
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Criba de Eratostenes segmentada, solo impares.
+//
+// [0, N] se parte en segmentos de NUMEROS_POR_SEGMENTO numeros; cada segmento
+// es un bitset de BYTES_SEGMENTO bytes (un bit por impar) que entra en la cache
+// L1. Para cribar un segmento solo se necesitan los primos base (<= sqrt(N)),
+// asi que los segmentos son independientes entre si y se pueden repartir entre
+// hilos sin compartir nada mas que los primos base (solo lectura).
+class CribaSegmentada {
+public:
+    static constexpr uint64_t BYTES_SEGMENTO = 32 * 1024;
+    static constexpr uint64_t BITS_SEGMENTO = BYTES_SEGMENTO * 8;
+    static constexpr uint64_t NUMEROS_POR_SEGMENTO = BITS_SEGMENTO * 2;
+
+    explicit CribaSegmentada(uint64_t N) : N_(N) {
+        uint64_t raiz = uint64_t(std::sqrt(double(N)));
+        while (raiz * raiz > N) raiz--;
+        while ((raiz + 1) * (raiz + 1) <= N) raiz++;
+        primos_base_ = primos_hasta(raiz);
+    }
+
+    uint64_t limite() const { return N_; }
+    uint64_t cantidad_segmentos() const { return N_ < 2 ? 0 : N_ / NUMEROS_POR_SEGMENTO + 1; }
+
+    // Criba el segmento `s` usando `bits` como buffer (se redimensiona) y llama a
+    // emitir(p) para cada primo del segmento, en orden creciente.
+    template <class Emitir>
+    void recorrer_segmento(uint64_t s, std::vector<uint64_t>& bits, Emitir&& emitir) const {
+        const uint64_t impares = cribar(s, bits);
+        const uint64_t lo = s * NUMEROS_POR_SEGMENTO;
+        if (s == 0 && N_ >= 2) emitir(uint64_t(2));
+        for (uint64_t w = 0; w * 64 < impares; w++) {
+            uint64_t palabra = bits[w];
+            while (palabra) {
+                uint64_t j = w * 64 + uint64_t(__builtin_ctzll(palabra));
+                emitir(lo + 2 * j + 1);
+                palabra &= palabra - 1;
+            }
+        }
+    }
+
+    // Cantidad de primos del segmento `s` (popcount del bitset, sin recorrerlos).
+    uint64_t contar_segmento(uint64_t s, std::vector<uint64_t>& bits) const {
+        const uint64_t impares = cribar(s, bits);
+        uint64_t cuenta = (s == 0 && N_ >= 2) ? 1 : 0;
+        for (uint64_t w = 0; w * 64 < impares; w++) cuenta += uint64_t(__builtin_popcountll(bits[w]));
+        return cuenta;
+    }
+
+    // Criba simple (solo para los primos base, hasta sqrt(N)).
+    static std::vector<uint64_t> primos_hasta(uint64_t limite) {
+        std::vector<uint64_t> primos;
+        if (limite < 2) return primos;
+        std::vector<bool> compuesto(limite + 1, false);
+        for (uint64_t i = 2; i <= limite; i++) {
+            if (compuesto[i]) continue;
+            primos.push_back(i);
+            for (uint64_t j = i * i; j <= limite; j += i) compuesto[j] = true;
+        }
+        return primos;
+    }
+
+    // Deja en `bits` (BITS_SEGMENTO bits) un 1 por cada impar primo del segmento
+    // `s`: el bit j representa a s * NUMEROS_POR_SEGMENTO + 2j + 1. Los bits
+    // posteriores al ultimo impar del segmento quedan en 0 y el 2 no se marca.
+    // Devuelve la cantidad de impares del segmento.
+    uint64_t cribar(uint64_t s, std::vector<uint64_t>& bits) const {
+        const uint64_t lo = s * NUMEROS_POR_SEGMENTO;                  // par
+        const uint64_t hi = std::min(N_ + 1, lo + NUMEROS_POR_SEGMENTO); // exclusivo
+        const uint64_t impares = lo < hi ? (hi - lo) / 2 : 0;         // impares en [lo, hi)
+
+        bits.assign(BITS_SEGMENTO / 64, ~uint64_t(0));
+        for (uint64_t p : primos_base_) {
+            if (p == 2) continue;
+            uint64_t inicio = p * p;
+            if (inicio >= hi) break;
+            if (inicio < lo) {
+                inicio = (lo + p - 1) / p * p;
+                if (inicio % 2 == 0) inicio += p;
+            }
+            for (uint64_t j = (inicio - lo) / 2; j < impares; j += p)
+                bits[j >> 6] &= ~(uint64_t(1) << (j & 63));
+        }
+
+        if (s == 0) bits[0] &= ~uint64_t(1); // el 1 no es primo
+        uint64_t ultima = impares / 64;
+        if (ultima < bits.size()) {
+            bits[ultima] &= (uint64_t(1) << (impares % 64)) - 1;
+            for (uint64_t w = ultima + 1; w < bits.size(); w++) bits[w] = 0;
+        }
+        return impares;
+    }
+
+private:
+    uint64_t N_;
+    std::vector<uint64_t> primos_base_;
+};
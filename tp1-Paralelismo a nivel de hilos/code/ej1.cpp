@@ -6,68 +6,124 @@
 #include <cmath>
 #include <chrono>
 #include <sys/time.h>
+#include "pool_hilos.h"
+#include "serie_log.h"
+#include "reduccion.h"
 
 using namespace std;
 using namespace std::chrono;
 
-long long N = 10000000;
+long long N = 10000000;        // maximo de terminos
+long long terminos = N;        // terminos a evaluar (menos si se pide --tolerancia=)
+serie_log::Kernel kernel_serie = serie_log::elegir_kernel(); // --kernel=auto|avx512|avx2|escalar
 
-double log_taylor_whithout_threads(double x)
+const long long BLOQUE_SERIE = 1 << 16; // terminos por bloque: fijo, no depende de los hilos
+
+// Suma de los terminos [ini, fin) con la politica elegida. La suma directa usa
+// el kernel SIMD; las demas agregan termino a termino.
+template <class Politica>
+Politica log_taylor_bloque(double r, long long ini, long long fin)
 {
-    double r = (x - 1) / (x + 1);
-    double sum = 0.0;
-    double pot = r; // r^n, comenzamos en n=0
-    for (long long n = 0; n < N; n++)
+    Politica suma;
+    if constexpr (is_same_v<Politica, SumaIngenua<double>>)
     {
-        sum += pot / (2 * n + 1);
-        pot *= r * r; // r^(2n+2) para el siguiente término
+        suma.agregar(kernel_serie(r, ini, fin));
     }
-
-    return 2 * sum; // ln(x) = 2 * sum
-    
+    else
+    {
+        double pot = pow(r, 2 * ini + 1); // arrancamos en r^(2*ini+1)
+        for (long long n = ini; n < fin; n++)
+        {
+            suma.agregar(pot / (2 * n + 1));
+            pot *= r * r; // r^(2n+2) para el siguiente término
+        }
+    }
+    return suma;
 }
 
-void log_taylor_multithreaded(double x, long long ini, long long fin, long double &resultado)
+// Ambas versiones recorren los mismos bloques y combinan sus parciales en orden
+// de bloque, asi que dan el mismo resultado bit a bit con cualquier cantidad de hilos.
+template <class Politica>
+double log_taylor_whithout_threads(double x)
 {
     double r = (x - 1) / (x + 1);
-    double sum = 0.0;
-    double pot = pow(r, ini); // arrancamos en r^ini
+    Politica sum;
+    for (long long ini = 0; ini < terminos; ini += BLOQUE_SERIE)
+        sum.combinar(log_taylor_bloque<Politica>(r, ini, min(terminos, ini + BLOQUE_SERIE)));
+    return 2 * sum.valor(); // ln(x) = 2 * sum
+}
 
-    for (long long n = ini; n <= fin; n++)
-    {
-        sum += pot / (2 * n + 1);
-        pot *= r * r; // r^(2n+2) para el siguiente término
-    }
-    resultado = 2 * sum; // ln(x) = 2 * sum
+template <class Politica>
+double log_taylor_multithreaded(double x, PoolHilos& pool)
+{
+    double r = (x - 1) / (x + 1);
+    long long bloques = (terminos + BLOQUE_SERIE - 1) / BLOQUE_SERIE;
+    Politica sum = pool.parallel_reduce(
+        0, size_t(bloques), 1, Politica{},
+        [&](size_t b, size_t) {
+            long long ini = (long long)b * BLOQUE_SERIE;
+            return log_taylor_bloque<Politica>(r, ini, min(terminos, ini + BLOQUE_SERIE));
+        },
+        [](Politica acumulado, const Politica& parcial) {
+            acumulado.combinar(parcial);
+            return acumulado;
+        });
+    return 2 * sum.valor(); // ln(x) = 2 * sum
 }
 
-int main()
+int main(int argc, char** argv)
 {
     long double x = 1600000; // Valor de x
-    int hilos = 4;
+    PoolHilos pool(PoolHilos::hilos_desde_argumentos(argc, argv)); // --hilos=N (por defecto, todos los nucleos)
+    int hilos = pool.cantidad_hilos();
+    double tolerancia = 0.0; // --tolerancia=E: cortar la serie cuando la cota del resto sea <= E
+    string politica = "ingenua"; // --suma=ingenua|kahan|pares|doble
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg.rfind("--kernel=", 0) == 0) kernel_serie = serie_log::elegir_kernel(arg.c_str() + 9);
+        if (arg.rfind("--tolerancia=", 0) == 0) tolerancia = stod(arg.substr(13));
+        if (arg.rfind("--suma=", 0) == 0) politica = arg.substr(7);
+    }
 
     //cout << "Ingrese el valor de x (> 1500000): ";
     //cin >> x;
-    //cout << "Ingrese el numero de hilos (divisor de 10000000): ";
-    //cin >> hilos;
 
-    if (x <= 1500000 || 10000000 % hilos != 0)
+    if (!politica_suma_valida(politica))
+    {
+        cout << "Politica de suma desconocida: " << politica << " (ingenua|kahan|pares|doble)" << endl;
+        return 1;
+    }
+
+    if (x <= 1500000)
     {
-        cout << "Valores invalidos. Asegurese que x > 1500000 y que el numero de hilos sea un divisor de 10000000." << endl;
+        cout << "Valor invalido. Asegurese que x > 1500000." << endl;
         return 0;
     }
 
+    // Cantidad de terminos: la cota del resto decrece con n, asi que alcanza con
+    // los primeros que la dejan por debajo de la tolerancia (a lo sumo N)
+    double r = double((x - 1) / (x + 1));
+    if (tolerancia > 0) terminos = serie_log::terminos_para_tolerancia(r, tolerancia, N);
+    cout << "Terminos: " << terminos << " de " << N << ", cota del error de truncamiento: "
+         << scientific << serie_log::cota_resto(r, terminos) << endl;
+    if (tolerancia > 0 && serie_log::cota_resto(r, terminos) > tolerancia)
+        cout << "Aviso: con " << N << " terminos no se alcanza la tolerancia " << tolerancia << endl;
+
     // ---------------------- SECUENCIAL ----------------------
     auto t1 = high_resolution_clock::now();
     timeval time1,time2;
     gettimeofday(&time1,NULL);
 
-    long double resultado_secuencial = log_taylor_whithout_threads(x);
+    long double resultado_secuencial = con_politica_suma(politica, [&](auto p) {
+        return log_taylor_whithout_threads<decltype(p)>(x);
+    });
 
     gettimeofday(&time2,NULL);
     cout << fixed;
     cout.precision(10);
 
+    cout << "\nKernel de la serie: " << serie_log::nombre_kernel(kernel_serie) << ", politica de suma: " << politica << endl;
     cout << "\n[SECUENCIAL] ln(" << x << ") ≈ " << resultado_secuencial << endl;
     cout << "Tiempo ejecución: " << (double(time2.tv_sec - time1.tv_sec) + double(time2.tv_usec-time1.tv_usec)/1000000) * 1000.0 << " ms" << endl;
     auto t2 = high_resolution_clock::now();
@@ -78,31 +134,18 @@ int main()
     // ---------------------- PARALELO ----------------------
     auto t3 = high_resolution_clock::now();
 
-    vector<thread> workers;
-    vector<long double> resultados(hilos, 0.0);
-
-    long long bloque = N / hilos;
-    for (int i = 0; i < hilos; i++)
-    {
-        if (i == 0) {
-            workers.push_back(thread(log_taylor_multithreaded, x, 0, bloque - 1, ref(resultados[i])));
-        }
-        else if (i == hilos - 1)
-        {
-            workers.push_back(thread(log_taylor_multithreaded, x, i * bloque, N - 1, ref(resultados[i])));
-        }
-        else
-        {
-            workers.push_back(thread(log_taylor_multithreaded, x, i * bloque, (i + 1) * bloque - 1, ref(resultados[i])));
-        }
-    }
-
-    for (auto &th : workers) th.join();
+    // Bloques fijos de la serie repartidos en el pool; los parciales se combinan en
+    // orden de bloque. Solo se reparten los terminos necesarios para la tolerancia pedida.
+    long double resultado_paralelo = con_politica_suma(politica, [&](auto p) {
+        return log_taylor_multithreaded<decltype(p)>(x, pool);
+    });
 
     auto t4 = high_resolution_clock::now();
     auto duracion_par = duration_cast<milliseconds>(t4 - t3).count();
 
+    cout << "\n[PARALELO] ln(" << x << ") ≈ " << resultado_paralelo << " (" << hilos << " hilos)" << endl;
     cout << "Tiempo paralelo: " << duracion_par << " ms" << endl;
+    cout << "Igual al secuencial (bit a bit): " << (resultado_paralelo == resultado_secuencial ? "si" : "no") << endl;
 
     //Speedup
     cout << "Speedup: " << double(duracion_seq) / double(duracion_par) << endl;
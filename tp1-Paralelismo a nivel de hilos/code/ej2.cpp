@@ -3,47 +3,51 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include "aho_corasick.h"
+#include "texto_mmap.h"
+#include "conteo_streaming.h"
 using namespace std;
 
-// Rabin-Karp con rolling hash: devuelve la cantidad de ocurrencias de un patrón
-size_t RabinKarp(const string& text, const string& pattern) {
-    int n = text.size(), m = pattern.size();
-    if (m == 0 || m > n) return 0;
+// Rolling hash polinomial modulo 2^64: la reduccion es el overflow natural de
+// uint64_t, asi que no hay divisiones ni restas "negativas" que corregir. Las
+// colisiones son posibles, por eso cada coincidencia de hash se verifica.
+const uint64_t RK_BASE = 1099511628211ULL;
 
-    const unsigned long long d = 256;
-    const unsigned long long q = 1000000007;
+uint64_t RabinKarpHash(string_view s) {
+    uint64_t h = 0;
+    for (unsigned char c : s) h = h * RK_BASE + c;
+    return h;
+}
 
-    unsigned long long h = 1, hashPattern = 0, hashText = 0;
-    size_t count = 0;
+uint64_t RabinKarpPotencia(size_t m) { // RK_BASE^(m-1)
+    uint64_t h = 1;
+    for (size_t i = 1; i < m; i++) h *= RK_BASE;
+    return h;
+}
 
-    for (int i = 0; i < m - 1; i++)
-        h = (h * d) % q;
+// Rabin-Karp con rolling hash: devuelve la cantidad de ocurrencias de un patrón
+size_t RabinKarp(string_view text, const string& pattern) {
+    const size_t n = text.size(), m = pattern.size();
+    if (m == 0 || m > n) return 0;
 
-    for (int i = 0; i < m; i++) {
-        hashPattern = (hashPattern * d + static_cast<unsigned char>(pattern[i])) % q;
-        hashText    = (hashText    * d + static_cast<unsigned char>(text[i])) % q;
-    }
+    const uint64_t h = RabinKarpPotencia(m);
+    const uint64_t hashPattern = RabinKarpHash(pattern);
+    uint64_t hashText = RabinKarpHash(text.substr(0, m));
+    size_t count = 0;
 
-    for (int i = 0; i <= n - m; i++) {
-        if (hashText == hashPattern){
-            bool match = true;
-            for (int j = 0; j < m; j++) {
-                if (text[i + j] != pattern[j]) {
-                    match = false;
-                    break;
-                }
-            }
-            if (match) count++;
-        }
-        if (i < n - m) {
-            hashText = (d * (hashText - static_cast<unsigned char>(text[i]) * h) + static_cast<unsigned char>(text[i + m])) % q;
-            if (hashText < 0) hashText += q;
-        }
+    for (size_t i = 0;; i++) {
+        if (hashText == hashPattern && text.compare(i, m, pattern) == 0) count++;
+        if (i == n - m) break;
+        hashText = (hashText - static_cast<unsigned char>(text[i]) * h) * RK_BASE
+                 + static_cast<unsigned char>(text[i + m]);
     }
     return count;
 }
 
-vector<size_t> RabinKarpSequential(const string& text, const vector<string>& patterns) {
+vector<size_t> RabinKarpSequential(string_view text, const vector<string>& patterns) {
     vector<size_t> counts;
     counts.reserve(patterns.size());
     for (const auto& p : patterns)
@@ -51,11 +55,58 @@ vector<size_t> RabinKarpSequential(const string& text, const vector<string>& pat
     return counts;
 }
 
-bool leer_texto(const string& ruta, string& texto) {
-    ifstream archivo(ruta, ios::binary);
-    if (!archivo) return false;
-    texto.assign((istreambuf_iterator<char>(archivo)), istreambuf_iterator<char>());
-    return true;
+// Variante multi-patron: los patrones (sin repetidos) se agrupan por longitud y
+// cada grupo se resuelve con UNA sola pasada del rolling hash, consultando en
+// cada posicion un filtro de bits de 64 Kbit y, si pasa, la tabla hash -> patrones.
+vector<size_t> RabinKarpMultiple(string_view text, const vector<string>& patterns) {
+    struct Grupo {
+        vector<uint64_t> filtro = vector<uint64_t>(1 << 10, 0);
+        unordered_multimap<uint64_t, size_t> por_hash; // hash -> patron unico
+    };
+    unordered_map<string, size_t> unicos;
+    vector<size_t> indice_unico(patterns.size());
+    map<size_t, Grupo> grupos;
+    for (size_t i = 0; i < patterns.size(); i++) {
+        auto it = unicos.find(patterns[i]);
+        if (it == unicos.end()) {
+            it = unicos.emplace(patterns[i], unicos.size()).first;
+            if (!patterns[i].empty() && patterns[i].size() <= text.size()) {
+                Grupo& g = grupos[patterns[i].size()];
+                uint64_t hp = RabinKarpHash(patterns[i]);
+                g.filtro[hp >> 54] |= 1ULL << ((hp >> 48) & 63);
+                g.por_hash.emplace(hp, it->second);
+            }
+        }
+        indice_unico[i] = it->second;
+    }
+    vector<const string*> texto_unico(unicos.size());
+    for (const auto& u : unicos) texto_unico[u.second] = &u.first;
+
+    vector<size_t> conteo_unico(unicos.size(), 0);
+    const size_t n = text.size();
+    for (auto& [m, g] : grupos) {
+        const uint64_t h = RabinKarpPotencia(m);
+        uint64_t hashText = RabinKarpHash(text.substr(0, m));
+        for (size_t i = 0;; i++) {
+            if (g.filtro[hashText >> 54] & (1ULL << ((hashText >> 48) & 63))) {
+                auto rango = g.por_hash.equal_range(hashText);
+                for (auto it = rango.first; it != rango.second; ++it)
+                    if (text.compare(i, m, *texto_unico[it->second]) == 0) conteo_unico[it->second]++;
+            }
+            if (i == n - m) break;
+            hashText = (hashText - static_cast<unsigned char>(text[i]) * h) * RK_BASE
+                     + static_cast<unsigned char>(text[i + m]);
+        }
+    }
+
+    vector<size_t> counts(patterns.size());
+    for (size_t i = 0; i < patterns.size(); i++) counts[i] = conteo_unico[indice_unico[i]];
+    return counts;
+}
+
+// El texto no se copia: se mapea en memoria y se recorre a traves de una vista
+bool leer_texto(const string& ruta, TextoMapeado& texto) {
+    return texto.abrir(ruta);
 }
 
 bool leer_patrones(const string& ruta, vector<string>& patterns) {
@@ -66,26 +117,74 @@ bool leer_patrones(const string& ruta, vector<string>& patterns) {
     return true;
 }
 
-int main() {
-    string texto;
+// Devuelve el valor de "--nombre=valor" si se paso por linea de comandos
+string leer_opcion(int argc, char** argv, const string& nombre, const string& por_defecto) {
+    string prefijo = "--" + nombre + "=";
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.rfind(prefijo, 0) == 0) return arg.substr(prefijo.size());
+    }
+    return por_defecto;
+}
+
+void mostrar_conteos(ostream& salida, const vector<size_t>& counts) {
+    for (size_t i = 0; i < counts.size(); i++)
+        salida << "El patrón " << i << " aparece " << counts[i] << " veces\n";
+}
+
+int main(int argc, char** argv) {
+    // --modo=completo:  busca sobre texto.txt completo (mapeado en memoria)
+    // --modo=streaming: lee --entrada (por defecto stdin) en bloques de --buffer bytes
+    //                   y cada --reporte bytes muestra los conteos parciales por stderr
+    // --motor=ac|rk:    en modo completo, Aho-Corasick o Rabin-Karp multi-patron
+    string modo = leer_opcion(argc, argv, "modo", "completo");
+    string motor = leer_opcion(argc, argv, "motor", "ac");
     vector<string> patterns;
 
     string ruta_texto = "/home/juan-ignacio/Escritorio/Facultad/Arquitecturas-Distribuidas/tp1-Paralelismo a nivel de hilos/texto.txt";
     string ruta_patrones = "/home/juan-ignacio/Escritorio/Facultad/Arquitecturas-Distribuidas/tp1-Paralelismo a nivel de hilos/patrones.txt";
 
-    if (!leer_texto(ruta_texto, texto)) {
-        cerr << "No se pudo leer texto.txt\n";
-        return 1;
-    }
     if (!leer_patrones(ruta_patrones, patterns)) {
         cerr << "No se pudo leer patrones.txt\n";
         return 2;
     }
+    AhoCorasick automata(patterns);
 
-    auto counts = RabinKarpSequential(texto, patterns);
+    if (modo == "streaming") {
+        string entrada = leer_opcion(argc, argv, "entrada", "-");
+        size_t tam_buffer = stoull(leer_opcion(argc, argv, "buffer", "1048576"));
+        uint64_t bytes_por_reporte = stoull(leer_opcion(argc, argv, "reporte", "268435456"));
 
-    for (size_t i = 0; i < counts.size(); i++)
-        cout << "El patrón " << i << " aparece " << counts[i] << " veces\n";
+        int fd = (entrada == "-") ? STDIN_FILENO : ::open(entrada.c_str(), O_RDONLY);
+        if (fd < 0 || tam_buffer == 0) {
+            cerr << "No se pudo abrir " << entrada << "\n";
+            return 1;
+        }
+        ContadorStreaming contador(automata);
+        bool ok = contar_streaming(fd, contador, tam_buffer, bytes_por_reporte, [](const ContadorStreaming& c) {
+            cerr << "[streaming] " << c.bytes_procesados() << " bytes procesados\n";
+            mostrar_conteos(cerr, c.conteos());
+        });
+        if (fd != STDIN_FILENO) ::close(fd);
+        if (!ok) {
+            cerr << "Error leyendo " << entrada << "\n";
+            return 1;
+        }
+        mostrar_conteos(cout, contador.conteos());
+        return 0;
+    }
+
+    TextoMapeado texto;
+    if (!leer_texto(ruta_texto, texto)) {
+        cerr << "No se pudo leer texto.txt\n";
+        return 1;
+    }
+
+    // Una sola pasada sobre el texto para todos los patrones (o una por longitud con rk)
+    auto counts = (motor == "rk") ? RabinKarpMultiple(texto.vista(), patterns)
+                                  : automata.contar(texto.vista());
+
+    mostrar_conteos(cout, counts);
 
     return 0;
 }
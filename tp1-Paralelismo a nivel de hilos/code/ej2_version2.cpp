@@ -4,30 +4,43 @@
 #include <string>
 #include <chrono>
 #include <thread>
+#include "aho_corasick.h"
+#include "conteo_por_bloques.h"
+#include "texto_mmap.h"
+#include "buscar_simd.h"
 
 using namespace std;
 using namespace std::chrono;
 
-// Función para contar cuántas veces aparece `pattern` en `text`
-size_t count_occurrences(const string& text, const string& pattern) {
-    size_t count = 0;
-    size_t pos = text.find(pattern, 0);
-    while (pos != string::npos) {
-        count++;
-        pos = text.find(pattern, pos + 1);
+// Función para contar cuántas veces aparece `pattern` en `text` (con solapamiento),
+// usando el kernel SIMD de primer/ultimo byte elegido segun la CPU
+size_t count_occurrences(string_view text, const string& pattern) {
+    return contar_ocurrencias_simd(text, pattern);
+}
+
+// Devuelve el valor de "--nombre=valor" si se paso por linea de comandos
+string leer_opcion(int argc, char** argv, const string& nombre, const string& por_defecto) {
+    string prefijo = "--" + nombre + "=";
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg.rfind(prefijo, 0) == 0) return arg.substr(prefijo.size());
     }
-    return count;
+    return por_defecto;
 }
 
-int main() {
-    // Leer todo el texto
-    ifstream text_file("/home/juan-ignacio/Escritorio/Facultad/Arquitecturas-Distribuidas/tp1-Paralelismo a nivel de hilos/texto.txt", ios::binary);
-    if (!text_file) {
+int main(int argc, char** argv) {
+    // --modo=patrones: una tarea por patron (cada tarea recorre todo el texto)
+    // --modo=bloques:  el texto se divide en bloques con solapamiento, una tarea por bloque
+    string modo = leer_opcion(argc, argv, "modo", "patrones");
+    PoolHilos pool(PoolHilos::hilos_desde_argumentos(argc, argv)); // --hilos=N (por defecto, todos los nucleos)
+
+    // Mapear el texto en memoria (sin copiarlo)
+    TextoMapeado text_file;
+    if (!text_file.abrir("/home/juan-ignacio/Escritorio/Facultad/Arquitecturas-Distribuidas/tp1-Paralelismo a nivel de hilos/texto.txt")) {
         cerr << "No se pudo abrir texto.txt\n";
         return 1;
     }
-    string text((istreambuf_iterator<char>(text_file)), istreambuf_iterator<char>());
-    text_file.close();
+    string_view text = text_file.vista();
 
     // Leer patrones
     ifstream pattern_file("/home/juan-ignacio/Escritorio/Facultad/Arquitecturas-Distribuidas/tp1-Paralelismo a nivel de hilos/patrones.txt");
@@ -45,11 +58,9 @@ int main() {
     // Medir tiempo de ejecución
     auto start = high_resolution_clock::now();
 
-    // Contar apariciones
-    vector<size_t> counts(patterns.size(), 0);
-    for (size_t i = 0; i < patterns.size(); ++i) {
-        counts[i] = count_occurrences(text, patterns[i]);
-    }
+    // Contar apariciones: una sola pasada con Aho-Corasick para todos los patrones
+    AhoCorasick automata(patterns);
+    vector<size_t> counts = automata.contar(text);
 
     auto end = high_resolution_clock::now();
     double elapsed_sec = duration<double>(end - start).count();
@@ -64,25 +75,22 @@ int main() {
     cout << "----------------------------------------\n" << endl;
 
     // Paralelo
-    vector<thread> workers;
     vector<size_t> parallel_counts(patterns.size(), 0);
 
     start = high_resolution_clock::now();
-    for (size_t i = 0; i < patterns.size(); ++i) {
-        workers.emplace_back([&, i]() {
-            parallel_counts[i] = count_occurrences(text, patterns[i]);
+    if (modo == "bloques") {
+        parallel_counts = contar_por_bloques(automata, text, pool);
+    } else {
+        pool.parallel_for(0, patterns.size(), 1, [&](size_t ini, size_t fin) {
+            for (size_t i = ini; i < fin; ++i) parallel_counts[i] = count_occurrences(text, patterns[i]);
         });
     }
 
-    for (auto& worker : workers) {
-        worker.join();
-    }
-
     end = high_resolution_clock::now();
     double elapsed_par = duration<double>(end - start).count();
 
     // Mostrar resultados paralelos
-    cout << "Resultados paralelos:\n";
+    cout << "Resultados paralelos (modo " << modo << "):\n";
 
     for (size_t i = 0; i < parallel_counts.size(); ++i) {
         cout << "El patron " << i << " aparece " << parallel_counts[i] << " veces\n";
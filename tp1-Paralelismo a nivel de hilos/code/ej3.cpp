@@ -4,112 +4,95 @@
 #include <string>
 #include <chrono>
 #include <thread>
+#include "gemm.h"
+#include "reduccion.h"
+#include "pool_hilos.h"
 
 using namespace std;
 using namespace std::chrono;
 
-float prod_matrix(const vector<vector<float>>& A, const vector<vector<float>>& B, int row, int col) {
-    float sum = 0.0f;
-    int n = A[0].size();
-    for (int k = 0; k < n; ++k) { 
-        sum += A[row][k] * B[k][col];
+// Devuelve el valor de "--nombre=valor" si se paso por linea de comandos
+string leer_opcion(int argc, char** argv, const string& nombre, const string& por_defecto) {
+    string prefijo = "--" + nombre + "=";
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg.rfind(prefijo, 0) == 0) return arg.substr(prefijo.size());
     }
-    return sum;
+    return por_defecto;
 }
 
-int main(){
+// Acumula en `suma` (un bloque por fila) los elementos de las filas [ini, fin) de C
+void sumar_filas(const Matriz& C, int ini, int fin, ReduccionPorBloques<>& suma) {
+    for (int i = ini; i < fin; ++i) {
+        auto& parcial = suma[i];
+        const float* fila = C.fila(i);
+        for (int j = 0; j < C.columnas; ++j) parcial.agregar(fila[j]);
+    }
+}
+
+// Las esquinas se informan una vez, fuera del cálculo
+void mostrar_esquinas(const Matriz& C) {
+    int N = C.filas;
+    cout << "Primer elemento: " << C(0, 0) << endl;
+    cout << "Elemento superior derecho: " << C(0, N - 1) << endl;
+    cout << "Elemento inferior izquierdo: " << C(N - 1, 0) << endl;
+    cout << "Ultimo elemento: " << C(N - 1, N - 1) << endl;
+}
+
+int main(int argc, char** argv){
     int N; // Tamaño de las matrices
-    int num_threads = 10; // Número de hilos
+    PoolHilos pool(PoolHilos::hilos_desde_argumentos(argc, argv)); // --hilos=N (por defecto, todos los nucleos)
+
+    // Tamaños de bloque del GEMM (--mc, --kc, --nc), ver gemm.h
+    TamaniosBloque bloques;
+    bloques.mc = stoi(leer_opcion(argc, argv, "mc", to_string(bloques.mc)));
+    bloques.kc = stoi(leer_opcion(argc, argv, "kc", to_string(bloques.kc)));
+    bloques.nc = stoi(leer_opcion(argc, argv, "nc", to_string(bloques.nc)));
 
     cout << "Ingrese el tamaño de las matrices (N x N): ";
     cin >> N;
 
-    // Inicializar matrices A y B con valores aleatorios
-    vector<vector<float>> A(N, vector<float>(N));
-    vector<vector<float>> B(N, vector<float>(N));
-    float sumatoria = 0.0f;
-
-    for (int i = 0; i < N; ++i)
-        for (int j = 0; j < N; ++j) {
-            A[i][j] = 0.1;
-            B[i][j] = 0.2;
-        }
+    // Inicializar matrices A y B (almacenamiento contiguo por filas)
+    Matriz A(N, N, 0.1f);
+    Matriz B(N, N, 0.2f);
+    Matriz C(N, N);
 
     // Medir tiempo de ejecución secuencial
     auto start_seq = high_resolution_clock::now();
 
-    for (int i = 0; i < N; ++i)
-        for (int j = 0; j < N; ++j){
-            if (j==0 && i==0){
-                float value = prod_matrix(A, B, i, j);
-                cout << "Primer elemento: " << value << endl;
-                sumatoria += value;
-            }else if ( i==N-1 && j==N-1 ){
-                float value = prod_matrix(A, B, i, j);
-                cout << "Ultimo elemento: " << value << endl;
-                sumatoria += value;
-            }else if (i==0 && j==N-1){
-                float value = prod_matrix(A, B, i, j);
-                cout << "Elemento superior derecho: " << value << endl;
-                sumatoria += value;
-            }else if (i==N-1 && j==0){
-                float value = prod_matrix(A, B, i, j);
-                cout << "Elemento inferior izquierdo: " << value << endl;
-                sumatoria += value;
-            }else{
-                sumatoria += prod_matrix(A, B, i, j);
-            }
-        }  
+    gemm_bloques(A, B, C, 0, N, bloques);
+    ReduccionPorBloques<> suma_seq(N);
+    sumar_filas(C, 0, N, suma_seq);
+    double sumatoria_seq = suma_seq.total();
 
     auto end_seq = high_resolution_clock::now();
     double elapsed_sec = duration<double>(end_seq - start_seq).count();
 
+    mostrar_esquinas(C);
+    cout << "Sumatoria: " << sumatoria_seq << endl;
     cout << "Tiempo de ejecución secuencial: " << elapsed_sec << " segundos\n";
     cout << "----------------------------------------\n" << endl;
 
     // Medir tiempo de ejecución paralelo
-    sumatoria = 0.0f;
     auto start_par = high_resolution_clock::now();
 
-    vector<thread> workers;
-    int rows_per_thread = N / num_threads;
-
-    for (int t = 0; t < num_threads; ++t) {
-        int start_row = t * rows_per_thread;
-        int end_row = (t == num_threads - 1) ? N : start_row + rows_per_thread;
-
-        workers.emplace_back([&, start_row, end_row]() {
-            for (int i = start_row; i < end_row; ++i)
-                for (int j = 0; j < N; ++j){
-                    if (j==0 && i==0){
-                        float value = prod_matrix(A, B, i, j);
-                        cout << "Primer elemento: " << value << endl;
-                        sumatoria += value;
-                    }else if ( i==N-1 && j==N-1 ){
-                        float value = prod_matrix(A, B, i, j);
-                        cout << "Ultimo elemento: " << value << endl;
-                        sumatoria += value;
-                    }else if (i==0 && j==N-1){
-                        float value = prod_matrix(A, B, i, j);
-                        cout << "Elemento superior derecho: " << value << endl;
-                        sumatoria += value;
-                    }else if (i==N-1 && j==0){
-                        float value = prod_matrix(A, B, i, j);
-                        cout << "Elemento inferior izquierdo: " << value << endl;
-                        sumatoria += value;
-                    }else{
-                        sumatoria += prod_matrix(A, B, i, j);
-                    }
-                }
-        });
-    }
+    ReduccionPorBloques<> suma_par(N); // un parcial por fila, cada uno en su linea de cache
 
-    for (auto& th : workers) th.join();
+    // Bandas de filas (multiplos de la altura del bloque del GEMM) repartidas en el pool
+    size_t filas_por_tarea = max(bloques.mc, 1);
+    pool.parallel_for(0, N, filas_por_tarea, [&](size_t start_row, size_t end_row) {
+        gemm_bloques(A, B, C, int(start_row), int(end_row), bloques);
+        sumar_filas(C, int(start_row), int(end_row), suma_par);
+    });
 
+    double sumatoria_par = suma_par.total();
     auto end_par = high_resolution_clock::now();
 
     double elapsed_par = duration<double>(end_par - start_par).count();
-    cout << "Tiempo de ejecución paralelo: " << elapsed_par << " segundos\n";
+    mostrar_esquinas(C);
+    cout << "Sumatoria: " << sumatoria_par
+         << (sumatoria_par == sumatoria_seq ? " (igual a la secuencial)" : " (DISTINTA de la secuencial)") << endl;
+    cout << "Tiempo de ejecución paralelo (" << pool.cantidad_hilos() << " hilos): " << elapsed_par << " segundos\n";
 
     //Speedup
     cout << "Speedup: " << elapsed_sec / elapsed_par << endl;
@@ -1,92 +1,132 @@
 #include <bits/stdc++.h>
 #include <thread>
-#include <mutex>
 #include <chrono>
+#include "pool_hilos.h"
+#include "criba_segmentada.h"
+#include "almacen_primos.h"
 using namespace std;
 
-mutex mtx;
-
-// --------------------
-// Chequear primalidad usando primos_base
-// --------------------
-bool esPrimo(long long n, const vector<long long>& primos_base) {
-    if (n < 2) return false;
-    if (n % 2 == 0 && n != 2) return false;
-    for (auto p : primos_base) {
-        if (p * p > n) break;      // condición de corte
-        if (n % p == 0) return false;
-    }
-    return true;
-}
-
 // --------------------
-// Paso 1: generar primos hasta sqrt(N)
+// SECUENCIAL: criba segmentada, segmento por segmento
+// (paso 1: primos base hasta sqrt(N), dentro de CribaSegmentada)
 // --------------------
-vector<long long> generarPrimosBase(long long limite) {
+vector<long long> primosSecuencial(long long N) {
     vector<long long> primos;
-    for (long long i = 2; i <= limite; i++) {
-        bool primo = true;
-        for (long long j = 2; j * j <= i; j++) {
-            if (i % j == 0) { primo = false; break; }
-        }
-        if (primo) primos.push_back(i);
+    if (N < 2) return primos;
+    CribaSegmentada criba(N);
+    vector<uint64_t> bits;
+
+    for (uint64_t s = 0; s < criba.cantidad_segmentos(); s++) {
+        criba.recorrer_segmento(s, bits, [&](uint64_t p) { primos.push_back((long long)p); });
     }
     return primos;
 }
 
 // --------------------
-// SECUENCIAL (pasos 1-3)
+// PARALELO: salida en dos fases, sin mutex ni sort
+// Los segmentos se reparten dinamicamente (contador atomico, ver
+// para_cada_segmento): cada hilo toma el siguiente segmento libre, asi ninguno
+// queda esperando a un bloque fijo mas caro que el resto.
+//  1) cada segmento publica cuantos primos tiene (popcount)
+//  2) una suma prefija exclusiva da el desplazamiento de cada segmento
+//  3) cada segmento se vuelve a cribar y escribe sus primos directamente en su
+//     lugar del vector ya dimensionado; como los segmentos se escriben en orden
+//     de posicion, el resultado queda ordenado
 // --------------------
-vector<long long> primosSecuencial(long long N) {
-    vector<long long> primos_base = generarPrimosBase(sqrt(N));
-    vector<long long> primos;
+void primosParcial(const CribaSegmentada& criba, uint64_t seg_ini, uint64_t seg_fin,
+                   const vector<uint64_t>& desplazamientos, vector<long long>& resultado) {
+    vector<uint64_t> bits;
+    for (uint64_t s = seg_ini; s < seg_fin; s++) {
+        long long* destino = resultado.data() + desplazamientos[s];
+        criba.recorrer_segmento(s, bits, [&](uint64_t p) { *destino++ = (long long)p; });
+    }
+}
 
-    for (long long i = 2; i <= N; i++) {
-        if (esPrimo(i, primos_base)) primos.push_back(i);
+vector<long long> primosParalelo(long long N, PoolHilos& pool, CargaTrabajadores& carga) {
+    vector<long long> resultado;
+    if (N < 2) return resultado;
+    CribaSegmentada criba(N);
+    const uint64_t segmentos = criba.cantidad_segmentos();
+
+    vector<uint64_t> conteos(segmentos);
+    para_cada_segmento(segmentos, &pool, [&](size_t ini, size_t fin) {
+        vector<uint64_t> bits;
+        for (size_t s = ini; s < fin; s++) conteos[s] = criba.contar_segmento(s, bits);
+    }, &carga);
+
+    vector<uint64_t> desplazamientos(segmentos);
+    uint64_t total = 0;
+    for (uint64_t s = 0; s < segmentos; s++) {
+        desplazamientos[s] = total;
+        total += conteos[s];
     }
-    return primos;
+
+    resultado.resize(total);
+    para_cada_segmento(segmentos, &pool, [&](size_t ini, size_t fin) {
+        primosParcial(criba, ini, fin, desplazamientos, resultado);
+    }, &carga);
+    return resultado;
 }
 
 // --------------------
-// PARALELO (pasos 1-3)
+// Formatos compactos (--formato=conteo|bitset|delta): misma criba, pero sin
+// materializar un vector<long long>. pool == nullptr -> secuencial.
 // --------------------
-void primosParcial(long long ini, long long fin, const vector<long long>& primos_base,
-                   vector<long long>& resultado) {
-    vector<long long> local;
-    for (long long i = ini; i <= fin; i++) {
-        if (i % 2 == 0 && i != 2) continue;  // descartar pares
-        if (esPrimo(i, primos_base)) local.push_back(i);
-    }
-    lock_guard<mutex> lock(mtx);
-    resultado.insert(resultado.end(), local.begin(), local.end());
+template <class Primos>
+void mostrarPrimos(const string& etiqueta, const Primos& primos, double tiempo) {
+    cout << "\n" << etiqueta << " " << primos.size() << " primos. Tiempo: " << tiempo << " s\n";
+    cout << "Ultimos 10 primos: ";
+    for (uint64_t p : primos.ultimos(10)) cout << p << " ";
+    cout << "\nMemoria: " << primos.bytes() << " bytes\n";
 }
 
-vector<long long> primosParalelo(long long N, int numHilos) {
-    vector<long long> primos_base = generarPrimosBase(sqrt(N));
-    vector<long long> resultado;
-    vector<thread> hilos;
+template <class Primos>
+double ejecutarFormato(const string& etiqueta, long long N, PoolHilos* pool, CargaTrabajadores* carga) {
+    auto t1 = chrono::high_resolution_clock::now();
+    CribaSegmentada criba(N < 0 ? 0 : N);
+    Primos primos = Primos::generar(criba, pool, carga);
+    auto t2 = chrono::high_resolution_clock::now();
+    double tiempo = chrono::duration<double>(t2 - t1).count();
+    mostrarPrimos(etiqueta, primos, tiempo);
+    return tiempo;
+}
 
-    long long bloque = N / numHilos;
-    for (int t = 0; t < numHilos; t++) {
-        long long ini = t * bloque + (t == 0 ? 2 : 1); // arranca en 2
-        long long fin = (t == numHilos - 1 ? N : (t + 1) * bloque);
-        hilos.emplace_back(primosParcial, ini, fin, cref(primos_base), ref(resultado));
+double ejecutarCompacto(FormatoPrimos formato, const string& etiqueta, long long N, PoolHilos* pool,
+                        CargaTrabajadores* carga = nullptr) {
+    switch (formato) {
+    case FormatoPrimos::Conteo: return ejecutarFormato<PrimosConteo>(etiqueta, N, pool, carga);
+    case FormatoPrimos::Bitset: return ejecutarFormato<PrimosBitset>(etiqueta, N, pool, carga);
+    default: return ejecutarFormato<PrimosDelta>(etiqueta, N, pool, carga);
     }
-    for (auto& th : hilos) th.join();
-
-    sort(resultado.begin(), resultado.end()); // paso 3
-    return resultado;
 }
 
 // --------------------
 // MAIN
 // --------------------
-int main() {
+int main(int argc, char** argv) {
     long long N;
-    int numHilos = 8;
+    PoolHilos pool(PoolHilos::hilos_desde_argumentos(argc, argv)); // --hilos=N (por defecto, todos los nucleos)
+    FormatoPrimos formato = FormatoPrimos::Vector; // --formato=vector|conteo|bitset|delta
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.rfind("--formato=", 0) == 0 && !parsear_formato(arg.substr(10), formato)) {
+            cerr << "Formato desconocido: " << arg.substr(10) << " (vector|conteo|bitset|delta)\n";
+            return 1;
+        }
+    }
     cout << "Ingrese N: ";
     cin >> N;
 
+    if (formato != FormatoPrimos::Vector) {
+        double tiempoSeq = ejecutarCompacto(formato, "[Secuencial]", N, nullptr);
+        CargaTrabajadores carga;
+        double tiempoPar = ejecutarCompacto(formato, "[Paralelo, " + to_string(pool.cantidad_hilos()) + " hilos]", N, &pool, &carga);
+        cout << "Carga por hilo:\n";
+        carga.mostrar(cout);
+        cout << "\nSpeedup = " << tiempoSeq / tiempoPar << "\n";
+        return 0;
+    }
+
     // ---- Secuencial ----
     auto t1 = chrono::high_resolution_clock::now();
     auto seq = primosSecuencial(N);
@@ -102,16 +142,18 @@ int main() {
 
     // ---- Paralelo ----
     auto t3 = chrono::high_resolution_clock::now();
-    auto par = primosParalelo(N, numHilos);
+    CargaTrabajadores carga;
+    auto par = primosParalelo(N, pool, carga);
     auto t4 = chrono::high_resolution_clock::now();
     double tiempoPar = chrono::duration<double>(t4 - t3).count();
 
-    cout << "\n[Paralelo] " << par.size() << " primos. Tiempo: "
+    cout << "\n[Paralelo, " << pool.cantidad_hilos() << " hilos] " << par.size() << " primos. Tiempo: "
          << tiempoPar << " s\n";
     cout << "Ultimos 10 primos: ";
     for (int i = max(0, (int)par.size() - 10); i < par.size(); i++)
         cout << par[i] << " ";
-    cout << "\n";
+    cout << "\nCarga por hilo:\n";
+    carga.mostrar(cout);
 
     cout << "\nSpeedup = " << tiempoSeq / tiempoPar << "\n";
 
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Matriz densa de floats en un unico bloque contiguo, por filas (row-major).
+struct Matriz {
+    int filas = 0, columnas = 0;
+    std::vector<float> datos;
+
+    Matriz() = default;
+    Matriz(int f, int c, float valor = 0.0f) : filas(f), columnas(c), datos(size_t(f) * c, valor) {}
+
+    float& operator()(int i, int j) { return datos[size_t(i) * columnas + j]; }
+    float operator()(int i, int j) const { return datos[size_t(i) * columnas + j]; }
+    float* fila(int i) { return datos.data() + size_t(i) * columnas; }
+    const float* fila(int i) const { return datos.data() + size_t(i) * columnas; }
+};
+
+// Tamanios de bloque del GEMM (en elementos):
+//  - kc: profundidad del bloque; un panel de B de kc x NR entra en L1.
+//  - mc: filas de A por bloque; el bloque empaquetado de mc x kc entra en L2.
+//  - nc: columnas de B por panel empaquetado (L3 / memoria).
+struct TamaniosBloque {
+    int mc = 96;
+    int kc = 256;
+    int nc = 4096;
+};
+
+namespace gemm_detalle {
+
+// Micro-kernel de MR x NR: 4 filas x 16 columnas de C acumuladas en registros.
+// Se escribe con vectores de la extension de GCC/Clang (8 floats con AVX, 4 con
+// SSE) para no depender de que el autovectorizador elija el lazo correcto.
+constexpr int MR = 4;
+constexpr int NR = 16;
+#ifdef __AVX__
+constexpr int VL = 8;
+#else
+constexpr int VL = 4;
+#endif
+typedef float vfloat __attribute__((vector_size(VL * sizeof(float))));
+
+// C(MR x NR) += Ap(MR x kc) * Bp(kc x NR), ambos empaquetados.
+inline void micro_kernel(int kc, const float* __restrict Ap, const float* __restrict Bp, float* __restrict C,
+                         int ldc, int filas_validas, int columnas_validas) {
+    vfloat acc[MR][NR / VL] = {};
+    for (int k = 0; k < kc; ++k) {
+        vfloat b[NR / VL];
+        __builtin_memcpy(b, Bp + size_t(k) * NR, sizeof(b));
+        const float* a = Ap + size_t(k) * MR;
+        for (int i = 0; i < MR; ++i)
+            for (int v = 0; v < NR / VL; ++v)
+                acc[i][v] += a[i] * b[v];
+    }
+    for (int i = 0; i < filas_validas; ++i)
+        for (int j = 0; j < columnas_validas; ++j)
+            C[size_t(i) * ldc + j] += acc[i][j / VL][j % VL];
+}
+
+// B[k0:k0+kc, j0:j0+nc] -> tiras de NR columnas, cada una kc x NR contigua (con ceros de relleno).
+inline void empaquetar_B(const Matriz& B, int k0, int kc, int j0, int nc, float* Bp) {
+    for (int jj = 0; jj < nc; jj += NR) {
+        int ancho = std::min(NR, nc - jj);
+        for (int k = 0; k < kc; ++k) {
+            const float* origen = B.fila(k0 + k) + j0 + jj;
+            float* destino = Bp + size_t(jj) * kc + size_t(k) * NR;
+            int j = 0;
+            for (; j < ancho; ++j) destino[j] = origen[j];
+            for (; j < NR; ++j) destino[j] = 0.0f;
+        }
+    }
+}
+
+// A[i0:i0+mc, k0:k0+kc] -> tiras de MR filas, cada una kc x MR contigua (con ceros de relleno).
+inline void empaquetar_A(const Matriz& A, int i0, int mc, int k0, int kc, float* Ap) {
+    for (int ii = 0; ii < mc; ii += MR) {
+        int alto = std::min(MR, mc - ii);
+        float* destino = Ap + size_t(ii) * kc;
+        for (int k = 0; k < kc; ++k) {
+            int i = 0;
+            for (; i < alto; ++i) destino[size_t(k) * MR + i] = A(i0 + ii + i, k0 + k);
+            for (; i < MR; ++i) destino[size_t(k) * MR + i] = 0.0f;
+        }
+    }
+}
+
+} // namespace gemm_detalle
+
+// C[fila_ini:fila_fin, :] = A[fila_ini:fila_fin, :] * B, por bloques.
+// Cada llamada usa sus propios buffers de empaquetado, asi que varios hilos
+// pueden calcular rangos de filas disjuntos de la misma C en paralelo.
+inline void gemm_bloques(const Matriz& A, const Matriz& B, Matriz& C, int fila_ini, int fila_fin,
+                         const TamaniosBloque& t = TamaniosBloque()) {
+    using namespace gemm_detalle;
+    const int n = B.columnas, kTotal = A.columnas;
+    const int mc = std::max(MR, t.mc - t.mc % MR), kc = std::max(1, t.kc), nc = std::max(NR, t.nc - t.nc % NR);
+
+    for (int i = fila_ini; i < fila_fin; ++i) std::fill(C.fila(i), C.fila(i) + n, 0.0f);
+
+    std::vector<float> Bp(size_t(kc) * nc);
+    std::vector<float> Ap(size_t(mc) * kc);
+    for (int j0 = 0; j0 < n; j0 += nc) {
+        int ncb = std::min(nc, n - j0);
+        for (int k0 = 0; k0 < kTotal; k0 += kc) {
+            int kcb = std::min(kc, kTotal - k0);
+            empaquetar_B(B, k0, kcb, j0, ncb, Bp.data());
+            for (int i0 = fila_ini; i0 < fila_fin; i0 += mc) {
+                int mcb = std::min(mc, fila_fin - i0);
+                empaquetar_A(A, i0, mcb, k0, kcb, Ap.data());
+                for (int jj = 0; jj < ncb; jj += NR)
+                    for (int ii = 0; ii < mcb; ii += MR)
+                        micro_kernel(kcb, Ap.data() + size_t(ii) * kcb, Bp.data() + size_t(jj) * kcb,
+                                     C.fila(i0 + ii) + j0 + jj, C.columnas,
+                                     std::min(MR, mcb - ii), std::min(NR, ncb - jj));
+            }
+        }
+    }
+}
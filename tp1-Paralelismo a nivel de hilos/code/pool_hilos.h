@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Pool de hilos reutilizable con robo de trabajo (work stealing).
+//
+// Cada hilo tiene su propia cola doble: toma tareas del final de la suya (LIFO,
+// datos calientes en cache) y, cuando se queda sin trabajo, roba del principio
+// de las colas de los demas (FIFO, los trozos mas grandes/viejos). Las tareas
+// enviadas desde fuera del pool se reparten round-robin entre las colas.
+//
+// Quien espera un parallel_for/parallel_reduce no se bloquea: ejecuta tareas
+// pendientes mientras tanto, asi que se pueden anidar sin deadlock.
+class PoolHilos {
+public:
+    // hilos == 0 -> std::thread::hardware_concurrency()
+    explicit PoolHilos(unsigned hilos = 0) {
+        if (hilos == 0) hilos = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < hilos; ++i) colas_.push_back(std::make_unique<Cola>());
+        for (unsigned i = 0; i < hilos; ++i) hilos_.emplace_back([this, i] { bucle_trabajador(i); });
+    }
+
+    PoolHilos(const PoolHilos&) = delete;
+    PoolHilos& operator=(const PoolHilos&) = delete;
+
+    ~PoolHilos() {
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            terminar_ = true;
+        }
+        cv_.notify_all();
+        for (auto& h : hilos_) h.join();
+    }
+
+    unsigned cantidad_hilos() const { return unsigned(hilos_.size()); }
+
+    // Encola f() y devuelve un future con su resultado.
+    template <class F>
+    auto enviar(F&& f) -> std::future<std::invoke_result_t<F>> {
+        using R = std::invoke_result_t<F>;
+        auto tarea = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> resultado = tarea->get_future();
+        encolar([tarea] { (*tarea)(); });
+        return resultado;
+    }
+
+    // cuerpo(a, b) sobre [ini, fin) partido en trozos de a lo sumo `grano` indices.
+    template <class F>
+    void parallel_for(size_t ini, size_t fin, size_t grano, F&& cuerpo) {
+        if (fin <= ini) return;
+        grano = std::max<size_t>(1, grano);
+        size_t trozos = (fin - ini + grano - 1) / grano;
+        std::atomic<size_t> restantes(trozos);
+        for (size_t t = 0; t < trozos; ++t) {
+            size_t a = ini + t * grano, b = std::min(fin, a + grano);
+            encolar([&cuerpo, &restantes, a, b] {
+                cuerpo(a, b);
+                restantes.fetch_sub(1, std::memory_order_release);
+            });
+        }
+        esperar_ayudando([&] { return restantes.load(std::memory_order_acquire) == 0; });
+    }
+
+    // Reduce [ini, fin): cada trozo de `grano` indices se evalua con mapear(a, b)
+    // y los resultados se combinan EN ORDEN de trozo, de modo que el resultado no
+    // depende de que hilo ejecuto cada trozo.
+    template <class T, class Mapear, class Combinar>
+    T parallel_reduce(size_t ini, size_t fin, size_t grano, T identidad, Mapear&& mapear, Combinar&& combinar) {
+        if (fin <= ini) return identidad;
+        grano = std::max<size_t>(1, grano);
+        std::vector<T> parciales((fin - ini + grano - 1) / grano, identidad);
+        parallel_for(ini, fin, grano, [&](size_t a, size_t b) { parciales[(a - ini) / grano] = mapear(a, b); });
+        T total = identidad;
+        for (auto& p : parciales) total = combinar(total, p);
+        return total;
+    }
+
+    // Cantidad de hilos pedida con "--hilos=N" (0 si no se paso).
+    static unsigned hilos_desde_argumentos(int argc, char** argv) {
+        const std::string prefijo = "--hilos=";
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind(prefijo, 0) == 0) return unsigned(std::stoul(arg.substr(prefijo.size())));
+        }
+        return 0;
+    }
+
+private:
+    struct Cola {
+        std::mutex mtx;
+        std::deque<std::function<void()>> tareas;
+    };
+
+    static int& indice_actual() {
+        static thread_local int indice = -1; // -1: hilo ajeno al pool
+        return indice;
+    }
+
+    void encolar(std::function<void()> tarea) {
+        int propio = indice_actual();
+        size_t destino = propio >= 0 ? size_t(propio) : siguiente_.fetch_add(1) % colas_.size();
+        {
+            std::lock_guard<std::mutex> lk(colas_[destino]->mtx);
+            colas_[destino]->tareas.push_back(std::move(tarea));
+        }
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            pendientes_++;
+        }
+        cv_.notify_one();
+    }
+
+    bool tomar(size_t preferida, std::function<void()>& tarea) {
+        {
+            Cola& c = *colas_[preferida];
+            std::lock_guard<std::mutex> lk(c.mtx);
+            if (!c.tareas.empty()) {
+                tarea = std::move(c.tareas.back());
+                c.tareas.pop_back();
+                pendientes_--;
+                return true;
+            }
+        }
+        for (size_t k = 1; k < colas_.size(); ++k) {
+            Cola& c = *colas_[(preferida + k) % colas_.size()];
+            std::lock_guard<std::mutex> lk(c.mtx);
+            if (!c.tareas.empty()) {
+                tarea = std::move(c.tareas.front());
+                c.tareas.pop_front();
+                pendientes_--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ejecutar_una(size_t preferida) {
+        std::function<void()> tarea;
+        if (!tomar(preferida, tarea)) return false;
+        tarea();
+        return true;
+    }
+
+    template <class Listo>
+    void esperar_ayudando(Listo listo) {
+        int propio = indice_actual();
+        size_t preferida = propio >= 0 ? size_t(propio) : 0;
+        while (!listo()) {
+            if (!ejecutar_una(preferida)) std::this_thread::yield();
+        }
+    }
+
+    void bucle_trabajador(unsigned indice) {
+        indice_actual() = int(indice);
+        for (;;) {
+            if (ejecutar_una(indice)) continue;
+            std::unique_lock<std::mutex> lk(mtx_);
+            cv_.wait(lk, [this] { return terminar_ || pendientes_ > 0; });
+            if (terminar_ && pendientes_ == 0) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Cola>> colas_;
+    std::vector<std::thread> hilos_;
+    std::atomic<size_t> siguiente_{0};
+    std::atomic<long> pendientes_{0};
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    bool terminar_ = false;
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Politicas de suma. Todas tienen la misma interfaz, para poder pasarlas como
+// parametro de template a cualquier reduccion:
+//
+//     agregar(x)      suma un termino
+//     combinar(otra)  suma el resultado parcial de otro acumulador
+//     valor()         resultado
+//
+// Son tipos triviales (se pueden copiar byte a byte, p. ej. para enviarlos por
+// MPI). El resultado solo depende del orden en que se agregan los terminos y se
+// combinan los parciales: para que no dependa de la cantidad de hilos o
+// procesos, las reducciones parten el dominio en bloques FIJOS y combinan los
+// parciales en orden de bloque.
+
+// Suma directa: la mas barata, error O(n * eps).
+template <class T = double>
+struct SumaIngenua {
+    static constexpr const char* nombre = "ingenua";
+    T suma = 0;
+
+    void agregar(T x) { suma += x; }
+    void combinar(const SumaIngenua& otra) { suma += otra.suma; }
+    T valor() const { return suma; }
+};
+
+// Acumulador compensado (Kahan-Babuska / Neumaier): guarda aparte el error de
+// redondeo de cada suma y lo reincorpora al final.
+template <class T = double>
+struct SumaKahan {
+    static constexpr const char* nombre = "kahan";
+    T suma = 0;
+    T compensacion = 0;
+
+    void agregar(T x) {
+        T t = suma + x;
+        if (std::fabs(suma) >= std::fabs(x)) compensacion += (suma - t) + x;
+        else compensacion += (x - t) + suma;
+        suma = t;
+    }
+    void combinar(const SumaKahan& otra) {
+        agregar(otra.suma);
+        compensacion += otra.compensacion;
+    }
+    T valor() const { return suma + compensacion; }
+};
+
+using SumaCompensada = SumaKahan<double>;
+
+// Suma por pares sobre un flujo: pila[k] guarda la suma de un grupo de 2^k
+// terminos consecutivos y dos grupos del mismo tamanio se suman apenas estan
+// completos (como un contador binario). Error O(log n * eps) sin guardar los
+// terminos. combinar() trata el parcial de otro acumulador como un termino mas.
+template <class T = double>
+struct SumaPares {
+    static constexpr const char* nombre = "pares";
+    T pila[64] = {};
+    int alto = 0;
+    uint64_t cantidad = 0;
+
+    void agregar(T x) {
+        ++cantidad;
+        for (uint64_t m = cantidad; (m & 1) == 0; m >>= 1) x = pila[--alto] + x;
+        pila[alto++] = x;
+    }
+    void combinar(const SumaPares& otra) { agregar(otra.valor()); }
+    T valor() const {
+        T s = 0;
+        for (int k = alto - 1; k >= 0; --k) s += pila[k];
+        return s;
+    }
+};
+
+// Doble-doble: el resultado se lleva como alto + bajo sin solapamiento (TwoSum
+// de Knuth en cada suma), casi el doble de bits de mantisa que T.
+template <class T = double>
+struct SumaDobleDoble {
+    static constexpr const char* nombre = "doble";
+    T alto = 0;
+    T bajo = 0;
+
+    void agregar(T x) { sumar(x, 0); }
+    void combinar(const SumaDobleDoble& otra) { sumar(otra.alto, otra.bajo); }
+    T valor() const { return alto + bajo; }
+
+private:
+    void sumar(T x, T x_bajo) {
+        T s = alto + x;
+        T bv = s - alto;
+        T error = (alto - (s - bv)) + (x - bv); // alto + x == s + error, exacto
+        error += bajo + x_bajo;
+        alto = s + error; // renormalizar con otro TwoSum (s y error pueden cancelarse)
+        bv = alto - s;
+        bajo = (s - (alto - bv)) + (error - bv);
+    }
+};
+
+inline bool politica_suma_valida(const std::string& nombre) {
+    return nombre == "ingenua" || nombre == "kahan" || nombre == "pares" || nombre == "doble";
+}
+
+// Llama a f(P{}) con la politica de nombre `nombre` (ver politica_suma_valida)
+// sobre el tipo T; f suele ser una lambda generica que usa decltype(P) como
+// parametro de template.
+template <class T = double, class F>
+decltype(auto) con_politica_suma(const std::string& nombre, F&& f) {
+    if (nombre == "kahan") return f(SumaKahan<T>{});
+    if (nombre == "pares") return f(SumaPares<T>{});
+    if (nombre == "doble") return f(SumaDobleDoble<T>{});
+    return f(SumaIngenua<T>{});
+}
+
+// Reduccion paralela determinista: el dominio se divide en una cantidad FIJA de
+// bloques (por ejemplo, una fila de la matriz por bloque), independiente de la
+// cantidad de hilos. Cada bloque tiene su parcial en su propia linea de cache
+// (sin false sharing entre hilos vecinos) y lo acumula con la politica elegida;
+// al final los parciales se combinan en orden de bloque. Asi el resultado es
+// bit a bit el mismo con 1 o con N hilos.
+template <class Politica = SumaCompensada>
+class ReduccionPorBloques {
+public:
+    struct alignas(64) Parcial {
+        Politica acumulador;
+        void agregar(double x) { acumulador.agregar(x); }
+    };
+
+    explicit ReduccionPorBloques(size_t bloques) : parciales_(bloques) {}
+
+    Parcial& operator[](size_t bloque) { return parciales_[bloque]; }
+    size_t bloques() const { return parciales_.size(); }
+
+    double total() const {
+        Politica total;
+        for (const Parcial& p : parciales_) total.combinar(p.acumulador);
+        return double(total.valor());
+    }
+
+private:
+    std::vector<Parcial> parciales_;
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+
+#include <immintrin.h>
+
+// Suma parcial de la serie de ln(x) = 2 * sum_{n>=0} r^(2n+1) / (2n+1), con
+// r = (x-1)/(x+1):
+//
+//     suma(r, ini, fin) = sum_{n=ini}^{fin-1} r^(2n+1) / (2n+1)
+//
+// La version escalar es una unica cadena de dependencias (pot *= r*r,
+// sum += pot/(2n+1)), limitada por la latencia de la FPU. Las versiones SIMD
+// reparten los terminos en S = carriles x acumuladores flujos intercalados: el
+// flujo j evalua n = ini + j, ini + j + S, ... con su propia potencia
+// (multiplicada por r^(2S) en cada paso), su propio denominador y su propio
+// acumulador, asi que no hay dependencias entre flujos. Los acumuladores se
+// combinan al final en un orden fijo.
+//
+// En ambas 1/(2n+1) se obtiene con un reciproco aproximado refinado por pasos de
+// Newton-Raphson con FMA (inv += inv * (1 - d * inv)), mas barato que vdivpd:
+//  - AVX-512: 8 carriles x 4 acumuladores; rcp14 + 2 pasos (14 -> 28 -> 56 bits).
+//  - AVX2:    4 carriles x 4 acumuladores; rcpps sobre floats + 3 pasos
+//             (12 -> 24 -> 48 -> 96 bits).
+//
+// Tolerancia: la version escalar acumula ~n * eps de error relativo en pot
+// (unos 1.5e-11 para 10^7 terminos); las SIMD dan S veces menos pasos por
+// flujo y quedan mas cerca del valor exacto. La diferencia relativa entre
+// kernels queda por debajo de 1e-10.
+//
+// La variante se elige en tiempo de ejecucion segun la CPU
+// (AVX-512 -> AVX2 -> escalar), o por nombre.
+
+namespace serie_log {
+
+inline double suma_escalar(double r, long long ini, long long fin) {
+    double sum = 0.0;
+    double pot = std::pow(r, double(2 * ini + 1));
+    for (long long n = ini; n < fin; n++) {
+        sum += pot / double(2 * n + 1);
+        pot *= r * r;
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+inline double suma_avx2(double r, long long ini, long long fin) {
+    constexpr int L = 4, A = 4, S = L * A;
+    if (fin - ini < S) return suma_escalar(r, ini, fin);
+
+    __m256d pot[A], den[A], acc[A];
+    for (int a = 0; a < A; a++) {
+        double p[L], d[L];
+        for (int l = 0; l < L; l++) {
+            long long n = ini + a * L + l;
+            p[l] = std::pow(r, double(2 * n + 1));
+            d[l] = double(2 * n + 1);
+        }
+        pot[a] = _mm256_loadu_pd(p);
+        den[a] = _mm256_loadu_pd(d);
+        acc[a] = _mm256_setzero_pd();
+    }
+    const __m256d q = _mm256_set1_pd(std::pow(r, double(2 * S)));
+    const __m256d paso = _mm256_set1_pd(double(2 * S));
+    const __m256d uno = _mm256_set1_pd(1.0);
+
+    long long n = ini;
+    for (; n + S <= fin; n += S) {
+        for (int a = 0; a < A; a++) {
+            __m256d inv = _mm256_cvtps_pd(_mm_rcp_ps(_mm256_cvtpd_ps(den[a])));
+            inv = _mm256_fmadd_pd(inv, _mm256_fnmadd_pd(den[a], inv, uno), inv);
+            inv = _mm256_fmadd_pd(inv, _mm256_fnmadd_pd(den[a], inv, uno), inv);
+            inv = _mm256_fmadd_pd(inv, _mm256_fnmadd_pd(den[a], inv, uno), inv);
+            acc[a] = _mm256_fmadd_pd(pot[a], inv, acc[a]);
+            pot[a] = _mm256_mul_pd(pot[a], q);
+            den[a] = _mm256_add_pd(den[a], paso);
+        }
+    }
+
+    __m256d total = _mm256_add_pd(_mm256_add_pd(acc[0], acc[1]), _mm256_add_pd(acc[2], acc[3]));
+    double t[L];
+    _mm256_storeu_pd(t, total);
+    return ((t[0] + t[1]) + (t[2] + t[3])) + suma_escalar(r, n, fin);
+}
+
+__attribute__((target("avx512f")))
+inline double suma_avx512(double r, long long ini, long long fin) {
+    constexpr int L = 8, A = 4, S = L * A;
+    if (fin - ini < S) return suma_escalar(r, ini, fin);
+
+    __m512d pot[A], den[A], acc[A];
+    for (int a = 0; a < A; a++) {
+        double p[L], d[L];
+        for (int l = 0; l < L; l++) {
+            long long n = ini + a * L + l;
+            p[l] = std::pow(r, double(2 * n + 1));
+            d[l] = double(2 * n + 1);
+        }
+        pot[a] = _mm512_loadu_pd(p);
+        den[a] = _mm512_loadu_pd(d);
+        acc[a] = _mm512_setzero_pd();
+    }
+    const __m512d q = _mm512_set1_pd(std::pow(r, double(2 * S)));
+    const __m512d paso = _mm512_set1_pd(double(2 * S));
+    const __m512d uno = _mm512_set1_pd(1.0);
+
+    long long n = ini;
+    for (; n + S <= fin; n += S) {
+        for (int a = 0; a < A; a++) {
+            __m512d inv = _mm512_maskz_rcp14_pd(0xFF, den[a]); // maskz: evita un falso -Wmaybe-uninitialized de GCC 12
+            inv = _mm512_fmadd_pd(inv, _mm512_fnmadd_pd(den[a], inv, uno), inv);
+            inv = _mm512_fmadd_pd(inv, _mm512_fnmadd_pd(den[a], inv, uno), inv);
+            acc[a] = _mm512_fmadd_pd(pot[a], inv, acc[a]);
+            pot[a] = _mm512_mul_pd(pot[a], q);
+            den[a] = _mm512_add_pd(den[a], paso);
+        }
+    }
+
+    __m512d total = _mm512_add_pd(_mm512_add_pd(acc[0], acc[1]), _mm512_add_pd(acc[2], acc[3]));
+    double t[L];
+    _mm512_storeu_pd(t, total);
+    return (((t[0] + t[1]) + (t[2] + t[3])) + ((t[4] + t[5]) + (t[6] + t[7]))) + suma_escalar(r, n, fin);
+}
+
+// Cota del error de truncar ln(x) en los primeros M terminos. Como
+// 1/(2n+1) <= 1/(2M+1) para n >= M, el resto queda acotado por una geometrica:
+//
+//     2 * sum_{n>=M} r^(2n+1)/(2n+1) <= 2 r^(2M+1) / ((2M+1) (1 - r^2))
+//
+// Se evalua en escala logaritmica para que no se anule por underflow.
+inline double log_cota_resto(double r, long long M) {
+    return std::log(2.0) + double(2 * M + 1) * std::log(r) - std::log(double(2 * M + 1)) -
+           std::log((1.0 - r) * (1.0 + r));
+}
+
+inline double cota_resto(double r, long long M) { return std::exp(log_cota_resto(r, M)); }
+
+// Menor M <= maximo cuya cota del resto es <= tolerancia (la cota decrece con
+// M, asi que alcanza una busqueda binaria). Si ni con `maximo` terminos se
+// llega a la tolerancia, devuelve `maximo`.
+inline long long terminos_para_tolerancia(double r, double tolerancia, long long maximo) {
+    if (r <= 0.0) return 0;
+    const double objetivo = std::log(tolerancia);
+    long long lo = 0, hi = maximo;
+    while (lo < hi) {
+        long long medio = lo + (hi - lo) / 2;
+        if (log_cota_resto(r, medio) <= objetivo) hi = medio;
+        else lo = medio + 1;
+    }
+    return lo;
+}
+
+using Kernel = double (*)(double, long long, long long);
+
+// nombre: "avx512", "avx2", "escalar" o nullptr/"auto" para el mejor disponible.
+// Un kernel pedido que la CPU no soporta cae al siguiente disponible.
+inline Kernel elegir_kernel(const char* nombre = nullptr) {
+    __builtin_cpu_init();
+    const bool automatico = nombre == nullptr || std::strcmp(nombre, "auto") == 0;
+    if (!automatico && std::strcmp(nombre, "escalar") == 0) return suma_escalar;
+    if ((automatico || std::strcmp(nombre, "avx512") == 0) && __builtin_cpu_supports("avx512f")) return suma_avx512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return suma_avx2;
+    return suma_escalar;
+}
+
+inline const char* nombre_kernel(Kernel k) {
+    return k == suma_avx512 ? "avx512" : k == suma_avx2 ? "avx2" : "escalar";
+}
+
+} // namespace serie_log
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cerrno>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Vista de solo lectura sobre un archivo de texto, sin copiarlo a un string.
+// Si el archivo es regular se mapea con mmap (las paginas se cargan a demanda
+// mientras se recorre, con aviso de acceso secuencial). Para pipes, FIFOs o
+// cuando mmap falla, se lee por bloques a un buffer propio.
+class TextoMapeado {
+public:
+    TextoMapeado() = default;
+    TextoMapeado(const TextoMapeado&) = delete;
+    TextoMapeado& operator=(const TextoMapeado&) = delete;
+    ~TextoMapeado() { cerrar(); }
+
+    // "-" lee de la entrada estandar.
+    bool abrir(const std::string& ruta) {
+        cerrar();
+        int fd = (ruta == "-") ? STDIN_FILENO : ::open(ruta.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat info{};
+        bool ok = false;
+        if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            void* p = ::mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                ::madvise(p, size_t(info.st_size), MADV_SEQUENTIAL);
+                mapa_ = p;
+                vista_ = std::string_view(static_cast<const char*>(p), size_t(info.st_size));
+                ok = true;
+            }
+        }
+        if (!ok) ok = leer_por_bloques(fd);
+
+        if (fd != STDIN_FILENO) ::close(fd);
+        return ok;
+    }
+
+    std::string_view vista() const { return vista_; }
+    bool mapeado() const { return mapa_ != nullptr; }
+
+private:
+    bool leer_por_bloques(int fd) {
+        const size_t BLOQUE = 1 << 20;
+        size_t usados = 0;
+        for (;;) {
+            buffer_.resize(usados + BLOQUE);
+            ssize_t leidos = ::read(fd, &buffer_[usados], BLOQUE);
+            if (leidos < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            if (leidos == 0) break;
+            usados += size_t(leidos);
+        }
+        buffer_.resize(usados);
+        vista_ = buffer_;
+        return true;
+    }
+
+    void cerrar() {
+        if (mapa_) ::munmap(mapa_, vista_.size());
+        mapa_ = nullptr;
+        vista_ = {};
+        buffer_.clear();
+    }
+
+    void* mapa_ = nullptr;
+    std::string buffer_;
+    std::string_view vista_;
+};
@@ -1,32 +1,72 @@
 #include <mpi.h>
 #include <bits/stdc++.h>
 #include <sys/time.h>
+#include "reduccion_mpi.h"
+#include "hibrido.h"
 using namespace std;
 
-static long double calcular_serie_parcial(long double valor_y, long double valor_y_cuadrado,
-                                          long long inicio, long long fin) {
-    if (inicio >= fin) return 0.0L;
+static const long long BLOQUE_SERIE = 1LL << 16; // terminos por bloque: fijo, no depende de los procesos
+
+template <class Politica>
+static Politica calcular_serie_parcial(long double valor_y, long double valor_y_cuadrado,
+                                       long long inicio, long long fin) {
+    Politica acumulador;
+    if (inicio >= fin) return acumulador;
     
     long double potencia = valor_y * powl(valor_y_cuadrado, (long double)inicio);
-    long double acumulador = 0.0L;
     
     for (long long indice = inicio; indice < fin; indice++) {
         long long denominador = 2LL * indice + 1LL;
-        acumulador += potencia / (long double)denominador;
+        acumulador.agregar(potencia / (long double)denominador);
         potencia *= valor_y_cuadrado;
     }
     return acumulador;
 }
 
+// Cota del error de truncar ln(x) en los primeros M terminos (en escala
+// logaritmica, para que no se anule por underflow):
+//   2 * sum_{n>=M} y^(2n+1)/(2n+1) <= 2 y^(2M+1) / ((2M+1) (1 - y^2))
+static long double log_cota_resto(long double valor_y, long long M) {
+    return logl(2.0L) + (long double)(2 * M + 1) * logl(valor_y) - logl((long double)(2 * M + 1)) -
+           logl((1.0L - valor_y) * (1.0L + valor_y));
+}
+
+// Menor M <= maximo con cota del resto <= tolerancia (la cota decrece con M).
+static long long terminos_para_tolerancia(long double valor_y, long double tolerancia, long long maximo) {
+    if (valor_y <= 0.0L) return 0;
+    long double objetivo = logl(tolerancia);
+    long long lo = 0, hi = maximo;
+    while (lo < hi) {
+        long long medio = lo + (hi - lo) / 2;
+        if (log_cota_resto(valor_y, medio) <= objetivo) hi = medio;
+        else lo = medio + 1;
+    }
+    return lo;
+}
+
 int main(int argc, char** argv) {
-    MPI_Init(&argc, &argv);  // 
+    unsigned hilos = iniciar_mpi_hibrido(&argc, &argv); // MPI_THREAD_FUNNELED + --hilos=N por proceso
+    PoolHilos pool(hilos);
 
     int rank = 0, size = 1;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
     long double valor_x = 1500000.0L; 
-    long long cantidad_terminos = 10000000LL;
+    long long cantidad_terminos = 10000000LL; // maximo de terminos
+    long double tolerancia = 0.0L; // --tolerancia=E: cortar cuando la cota del resto sea <= E
+    string politica = "ingenua";    // --suma=ingenua|kahan|pares|doble
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.rfind("--tolerancia=", 0) == 0) tolerancia = stold(arg.substr(13));
+        if (arg.rfind("--suma=", 0) == 0) politica = arg.substr(7);
+    }
+    if (!politica_suma_valida(politica)) {
+        if (rank == 0) cerr << "Politica de suma desconocida: " << politica << " (ingenua|kahan|pares|doble)" << endl;
+        MPI_Finalize();
+        return 1;
+    }
+    const long long maximo_terminos = cantidad_terminos;
     
     if (rank == 0) {
         cerr << "Ingrese x (>=1500000) [Enter para usar 1500000]: ";
@@ -34,6 +74,12 @@ int main(int argc, char** argv) {
         if (cin >> entrada_x) valor_x = entrada_x;
         cin.clear(); 
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
+
+        // El reparto de terminos entre procesos se planifica sobre los necesarios
+        if (tolerancia > 0.0L && valor_x >= 1500000.0L) {
+            long double y = (valor_x - 1.0L) / (valor_x + 1.0L);
+            cantidad_terminos = terminos_para_tolerancia(y, tolerancia, maximo_terminos);
+        }
     }
 
     MPI_Bcast(&valor_x, 1, MPI_LONG_DOUBLE, 0, MPI_COMM_WORLD);
@@ -50,20 +96,28 @@ int main(int argc, char** argv) {
     long double var_y  = (valor_x - 1.0L) / (valor_x + 1.0L);
     long double var_y_cuadrado = var_y * var_y;
 
-    long long terminos_base = cantidad_terminos / size;
-    long long resto  = cantidad_terminos % size;
-    long long indice_inicial = rank * terminos_base + min<long long>(rank, resto);
-    long long cantidad_a_tomar = terminos_base + (rank < resto ? 1 : 0);
-    long long indice_final = indice_inicial + cantidad_a_tomar;
+    // Cada proceso toma un rango contiguo de bloques enteros
+    RangoBloques rango = repartir_bloques(cantidad_terminos, BLOQUE_SERIE, rank, size);
 
     MPI_Barrier(MPI_COMM_WORLD);
     timeval tiempo_inicio{}, tiempo_fin{};
     if (rank == 0) gettimeofday(&tiempo_inicio, nullptr);
 
-    long double resultado_parcial = calcular_serie_parcial(var_y, var_y_cuadrado, indice_inicial, indice_final);
-
-    long double total_global = 0.0L;
-    MPI_Reduce(&resultado_parcial, &total_global, 1, MPI_LONG_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    // Un parcial por bloque; la raiz los combina en orden de bloque, asi el
+    // resultado no depende de la cantidad de procesos
+    long double total_global = con_politica_suma<long double>(politica, [&](auto p) {
+        using Politica = decltype(p);
+        // Los bloques del proceso se reparten entre sus hilos; cada uno escribe su parcial
+        vector<Politica> parciales(size_t(rango.fin_bloque - rango.primer_bloque));
+        pool.parallel_for(0, parciales.size(), 1, [&](size_t a, size_t fin_trozo) {
+            for (size_t i = a; i < fin_trozo; i++) {
+                long long inicio = (rango.primer_bloque + (long long)i) * BLOQUE_SERIE;
+                parciales[i] = calcular_serie_parcial<Politica>(var_y, var_y_cuadrado, inicio,
+                                                                min(cantidad_terminos, inicio + BLOQUE_SERIE));
+            }
+        });
+        return combinar_bloques_en_orden(parciales, 0, MPI_COMM_WORLD).valor();
+    });
 
     if (rank == 0) {
         gettimeofday(&tiempo_fin, nullptr);
@@ -71,7 +125,13 @@ int main(int argc, char** argv) {
 
         long double logaritmo_natural = 2.0L * total_global;
         cout << setprecision(15) << fixed;
-        cout << "ln(x) = " << logaritmo_natural << "\n";
+        cout << "ln(x) = " << logaritmo_natural << " (suma " << politica << ")\n";
+        cout << "Terminos: " << cantidad_terminos << " de " << maximo_terminos
+             << ", cota del error de truncamiento: " << scientific << expl(log_cota_resto(var_y, cantidad_terminos))
+             << fixed << "\n";
+        if (tolerancia > 0.0L && log_cota_resto(var_y, cantidad_terminos) > logl(tolerancia))
+            cout << "Aviso: con " << maximo_terminos << " terminos no se alcanza la tolerancia pedida\n";
+        cout << "Procesos: " << size << ", hilos por proceso: " << pool.cantidad_hilos() << "\n";
         cout << "Tiempo (s) = " << duracion << "\n";
     }
 
@@ -80,4 +140,7 @@ int main(int argc, char** argv) {
 }
 // mpicxx -O3 -march=native -o ej1.out ej1.cpp 
 // mpirun -n 8 ./ej1.out
+// mpirun -n 2 --map-by ppr:1:node --bind-to none ./ej1.out --hilos=8   (hibrido: un proceso por nodo)
+// mpirun -n 8 ./ej1.out --tolerancia=1e-10
+// mpirun -n 8 ./ej1.out --suma=kahan   (ingenua|kahan|pares|doble)
 // mpirun -n 32 --hostfile machinesfile.txt ./ej1.out
\ No newline at end of file
@@ -4,6 +4,12 @@
 #include <unistd.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "buscar_simd.h"
+#include "hibrido.h"
+#include "memoria_nodo.h"
 using namespace std;
 
 // ---------------------- Funciones auxiliares ----------------------
@@ -35,19 +41,84 @@ static string conseguir_direccion_ip() {
     return direccion_ip ? string(direccion_ip) : "0.0.0.0";
 }
 
-static bool cargar_contenido_archivo(const string& ruta_archivo, string& contenido) {
-    ifstream archivo(ruta_archivo, ios::in | ios::binary);
-    if (!archivo) return false;
-    
-    archivo.seekg(0, ios::end);
-    size_t tamanio = (size_t)archivo.tellg();
-    contenido.resize(tamanio);
-    archivo.seekg(0, ios::beg);
-    
-    if (tamanio > 0) archivo.read(&contenido[0], tamanio);
+// Texto de solo lectura: mapeado con mmap cuando es un archivo regular (sin
+// copia previa, las paginas se cargan mientras se recorre) o leido por bloques
+// a un buffer propio cuando es un pipe o mmap no esta disponible.
+struct ContenidoArchivo {
+    void* mapa = nullptr;
+    string buffer;
+    string_view vista;
+
+    ContenidoArchivo() = default;
+    ContenidoArchivo(const ContenidoArchivo&) = delete;
+    ContenidoArchivo& operator=(const ContenidoArchivo&) = delete;
+    ~ContenidoArchivo() { if (mapa) ::munmap(mapa, vista.size()); }
+};
+
+static bool leer_descriptor_por_bloques(int descriptor, string& destino) {
+    const size_t TAM_BLOQUE = 1 << 20;
+    size_t usados = 0;
+    while (true) {
+        destino.resize(usados + TAM_BLOQUE);
+        ssize_t leidos = ::read(descriptor, &destino[usados], TAM_BLOQUE);
+        if (leidos < 0 && errno == EINTR) continue;
+        if (leidos < 0) return false;
+        if (leidos == 0) break;
+        usados += (size_t)leidos;
+    }
+    destino.resize(usados);
     return true;
 }
 
+static bool cargar_contenido_archivo(const string& ruta_archivo, ContenidoArchivo& contenido) {
+    int descriptor = ::open(ruta_archivo.c_str(), O_RDONLY);
+    if (descriptor < 0) return false;
+
+    struct stat informacion{};
+    bool exito = false;
+    if (::fstat(descriptor, &informacion) == 0 && S_ISREG(informacion.st_mode) && informacion.st_size > 0) {
+        size_t tamanio = (size_t)informacion.st_size;
+        void* mapa = ::mmap(nullptr, tamanio, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapa != MAP_FAILED) {
+            ::madvise(mapa, tamanio, MADV_SEQUENTIAL);
+            contenido.mapa = mapa;
+            contenido.vista = string_view((const char*)mapa, tamanio);
+            exito = true;
+        }
+    }
+    if (!exito && leer_descriptor_por_bloques(descriptor, contenido.buffer)) {
+        contenido.vista = contenido.buffer;
+        exito = true;
+    }
+
+    ::close(descriptor);
+    return exito;
+}
+
+// Lee [inicio, fin) de un archivo abierto con MPI_File_open en `destino`, con
+// MPI_File_read_at_all. Es colectiva: todos los procesos la llaman, cada uno con
+// su rango (puede ser vacio). La cantidad por llamada es int, asi que se lee en
+// tandas de a lo sumo 1 GiB y todos hacen la misma cantidad de tandas.
+static bool leer_rango_colectivo(MPI_File archivo, size_t inicio, size_t fin, string& destino) {
+    const size_t TANDA = size_t(1) << 30;
+    destino.resize(fin - inicio);
+    long long tandas_locales = (long long)((fin - inicio + TANDA - 1) / TANDA), tandas = 0;
+    MPI_Allreduce(&tandas_locales, &tandas, 1, MPI_LONG_LONG, MPI_MAX, MPI_COMM_WORLD);
+
+    bool exito = true;
+    for (long long t = 0; t < tandas; ++t) {
+        size_t desde = min(fin, inicio + size_t(t) * TANDA);
+        size_t cantidad = min(TANDA, fin - desde);
+        MPI_Status estado;
+        int leidos = 0;
+        if (MPI_File_read_at_all(archivo, (MPI_Offset)desde, &destino[desde - inicio], (int)cantidad, MPI_CHAR, &estado) != MPI_SUCCESS)
+            exito = false;
+        else if (MPI_Get_count(&estado, MPI_CHAR, &leidos), size_t(leidos) != cantidad)
+            exito = false;
+    }
+    return exito;
+}
+
 static bool cargar_patrones_desde_archivo(const string& ruta, vector<string>& lista_patrones) {
     ifstream archivo(ruta);
     if (!archivo) return false;
@@ -61,31 +132,220 @@ static bool cargar_patrones_desde_archivo(const string& ruta, vector<string>& li
     return true;
 }
 
-static int contar_ocurrencias_con_solapamiento(const string& texto_completo, const string& patron) {
-    if (patron.empty()) return 0;
-    
-    int contador = 0;
-    size_t posicion = 0;
-    
-    while ((posicion = texto_completo.find(patron, posicion)) != string::npos) {
-        contador++;
-        posicion++;
+static uint64_t contar_ocurrencias_con_solapamiento(string_view texto_completo, const string& patron) {
+    return (uint64_t)contar_ocurrencias_simd(texto_completo, patron);
+}
+
+// Cuenta las ocurrencias que COMIENZAN en [inicio, fin). Se busca sobre el rango
+// extendido hasta fin + (longitud del patron - 1) para no perder las que cruzan
+// el borde; las que empiezan en el solapamiento las cuenta el bloque siguiente.
+static long long contar_ocurrencias_en_rango(string_view texto_completo, const string& patron,
+                                             size_t inicio, size_t fin) {
+    if (patron.empty() || inicio >= fin) return 0;
+
+    size_t limite = min(texto_completo.size(), fin + patron.size() - 1);
+    string_view rango = texto_completo.substr(inicio, limite - inicio);
+    return (long long)contar_ocurrencias_simd(rango, patron);
+}
+
+// Resultado de un patron tal como viaja al proceso 0: cada proceso manda solo
+// los de los patrones que busco, O(patrones) en total.
+struct RegistroPatron {
+    uint64_t conteo;
+    int32_t patron;
+    int32_t proceso; // quien lo busco; -1 si nadie
+};
+
+// Tipo MPI de RegistroPatron con los desplazamientos reales del struct (y su
+// sizeof como extension, para mandar arreglos).
+static MPI_Datatype tipo_registro_patron() {
+    int largos[3] = {1, 1, 1};
+    MPI_Aint desplazamientos[3] = {offsetof(RegistroPatron, conteo), offsetof(RegistroPatron, patron),
+                                   offsetof(RegistroPatron, proceso)};
+    MPI_Datatype tipos[3] = {MPI_UINT64_T, MPI_INT32_T, MPI_INT32_T};
+    MPI_Datatype tipo, tipo_arreglo;
+    MPI_Type_create_struct(3, largos, desplazamientos, tipos, &tipo);
+    MPI_Type_create_resized(tipo, 0, sizeof(RegistroPatron), &tipo_arreglo);
+    MPI_Type_free(&tipo);
+    MPI_Type_commit(&tipo_arreglo);
+    return tipo_arreglo;
+}
+
+// Resultados del reparto de patrones: un registro por patron (indexado por
+// patron, solo en el proceso 0) mas lo que hizo este proceso.
+struct ResultadoPatrones {
+    vector<RegistroPatron> registros;
+    double ocupado = 0; // segundos contando (dentro de parallel_for)
+    long long patrones = 0, lotes = 0;
+};
+
+// Reparto estatico: tramos contiguos de igual cantidad de patrones por proceso.
+static ResultadoPatrones buscar_patrones_estatico(PoolHilos& pool, string_view texto, const vector<string>& patrones,
+                                                  int rank, int size, MPI_Datatype tipo_registro) {
+    const int total_patrones = (int)patrones.size();
+    int patrones_por_proceso = total_patrones / size;
+    int patrones_restantes = total_patrones % size;
+    int indice_inicio = rank * patrones_por_proceso + min(rank, patrones_restantes);
+    int cantidad_patrones = patrones_por_proceso + (rank < patrones_restantes ? 1 : 0);
+    int indice_fin = indice_inicio + cantidad_patrones;
+
+    ResultadoPatrones resultado;
+    vector<RegistroPatron> locales(cantidad_patrones);
+
+    // Los patrones del proceso se reparten entre sus hilos (uno por tarea)
+    double t0 = MPI_Wtime();
+    pool.parallel_for(indice_inicio, indice_fin, 1, [&](size_t a, size_t b) {
+        for (size_t idx = a; idx < b; ++idx)
+            locales[idx - indice_inicio] = {contar_ocurrencias_con_solapamiento(texto, patrones[idx]), (int32_t)idx, rank};
+    });
+    resultado.ocupado = MPI_Wtime() - t0;
+    resultado.patrones = cantidad_patrones;
+    resultado.lotes = 1;
+
+    // Un solo MPI_Gatherv con los registros de cada proceso
+    vector<int> cantidades(size), desplazamientos(size);
+    MPI_Gather(&cantidad_patrones, 1, MPI_INT, cantidades.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    vector<RegistroPatron> recibidos;
+    if (rank == 0) {
+        for (int p = 1; p < size; ++p) desplazamientos[p] = desplazamientos[p - 1] + cantidades[p - 1];
+        recibidos.resize(total_patrones);
     }
-    return contador;
+    MPI_Gatherv(locales.data(), cantidad_patrones, tipo_registro, recibidos.data(), cantidades.data(),
+                desplazamientos.data(), tipo_registro, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        resultado.registros.resize(total_patrones);
+        for (int idx = 0; idx < total_patrones; ++idx) resultado.registros[idx] = {0, idx, -1};
+        for (const RegistroPatron& r : recibidos) resultado.registros[r.patron] = r;
+    }
+    return resultado;
+}
+
+// Reparto dinamico: el costo de un patron depende de su largo y de cuantas veces
+// aparece, asi que en lugar de tramos fijos cada proceso pide lotes de `lote`
+// patrones a un contador atomico en una ventana RMA del proceso 0
+// (MPI_Fetch_and_op) y escribe los registros de cada lote terminado directo en
+// la ventana de resultados del proceso 0 (MPI_Put). No hay un maestro atendiendo
+// pedidos: el proceso 0 busca patrones como los demas.
+//
+// El lote siguiente se pide antes de contar el actual, para que el pedido viaje
+// mientras se cuenta; cada proceso tiene a lo sumo un lote reservado de mas.
+static ResultadoPatrones buscar_patrones_dinamico(PoolHilos& pool, string_view texto, const vector<string>& patrones,
+                                                  int rank, int lote, MPI_Datatype tipo_registro) {
+    const int total_patrones = (int)patrones.size();
+    ResultadoPatrones resultado;
+
+    long long* contador = nullptr;
+    RegistroPatron* resultados = nullptr; // uno por patron
+    MPI_Win ventana_contador, ventana_resultados;
+    MPI_Win_allocate(rank == 0 ? sizeof(long long) : 0, sizeof(long long), MPI_INFO_NULL, MPI_COMM_WORLD,
+                     &contador, &ventana_contador);
+    MPI_Win_allocate(rank == 0 ? total_patrones * sizeof(RegistroPatron) : 0, sizeof(RegistroPatron), MPI_INFO_NULL,
+                     MPI_COMM_WORLD, &resultados, &ventana_resultados);
+    if (rank == 0) {
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, ventana_contador);
+        *contador = 0;
+        MPI_Win_unlock(0, ventana_contador);
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, ventana_resultados);
+        for (int idx = 0; idx < total_patrones; ++idx) resultados[idx] = {0, idx, -1};
+        MPI_Win_unlock(0, ventana_resultados);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    MPI_Win_lock_all(0, ventana_contador);
+    MPI_Win_lock_all(0, ventana_resultados);
+    const long long incremento = lote;
+    long long actual = 0, siguiente = 0;
+    MPI_Fetch_and_op(&incremento, &actual, MPI_LONG_LONG, 0, 0, MPI_SUM, ventana_contador);
+    MPI_Win_flush(0, ventana_contador);
+
+    vector<RegistroPatron> registros_lote(lote);
+    while (actual < total_patrones) {
+        MPI_Fetch_and_op(&incremento, &siguiente, MPI_LONG_LONG, 0, 0, MPI_SUM, ventana_contador);
+
+        const int inicio = (int)actual, fin = (int)min<long long>(total_patrones, actual + lote);
+        double t0 = MPI_Wtime();
+        pool.parallel_for(inicio, fin, 1, [&](size_t a, size_t b) {
+            for (size_t idx = a; idx < b; ++idx)
+                registros_lote[idx - inicio] = {contar_ocurrencias_con_solapamiento(texto, patrones[idx]), (int32_t)idx, rank};
+        });
+        resultado.ocupado += MPI_Wtime() - t0;
+        resultado.patrones += fin - inicio;
+        ++resultado.lotes;
+
+        MPI_Put(registros_lote.data(), fin - inicio, tipo_registro, 0, inicio, fin - inicio, tipo_registro, ventana_resultados);
+        MPI_Win_flush(0, ventana_resultados); // el buffer del lote se reusa
+        MPI_Win_flush(0, ventana_contador);
+        actual = siguiente;
+    }
+    MPI_Win_unlock_all(ventana_resultados);
+    MPI_Win_unlock_all(ventana_contador);
+
+    // Todos terminaron sus MPI_Put: el proceso 0 lee su ventana
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (rank == 0) {
+        MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, ventana_resultados);
+        resultado.registros.assign(resultados, resultados + total_patrones);
+        MPI_Win_unlock(0, ventana_resultados);
+    }
+    MPI_Win_free(&ventana_resultados);
+    MPI_Win_free(&ventana_contador);
+    return resultado;
+}
+
+static string leer_opcion(int argc, char** argv, const string& nombre, const string& por_defecto) {
+    string prefijo = "--" + nombre + "=";
+    for (int i = 1; i < argc; ++i) {
+        string argumento = argv[i];
+        if (argumento.rfind(prefijo, 0) == 0) return argumento.substr(prefijo.size());
+    }
+    return por_defecto;
 }
 
 // ---------------------- Programa principal ----------------------
 
 int main(int argc, char** argv) {
-    MPI_Init(&argc, &argv);
+    unsigned hilos = iniciar_mpi_hibrido(&argc, &argv); // MPI_THREAD_FUNNELED + --hilos=N por proceso
+    PoolHilos pool(hilos);
 
     int rank = 0, size = 1;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
-    string contenido_texto;
+    // --modo=patrones: cada proceso busca un subconjunto de patrones en todo el texto
+    // --modo=bloques:  cada proceso busca todos los patrones en un bloque del texto
+    // --lectura=particionada: en modo bloques cada proceso lee solo su bloque con MPI-IO (por defecto)
+    // --lectura=completa: todos cargan texto.txt entero (el modo por patrones siempre lo necesita)
+    const string modo = leer_opcion(argc, argv, "modo", "patrones");
+    // --texto=nodo: el proceso 0 lee texto.txt y lo difunde a una copia por nodo en memoria compartida (por defecto)
+    // --texto=proceso: cada proceso carga su propia copia de texto.txt
+    const bool particionada = modo == "bloques" && leer_opcion(argc, argv, "lectura", "particionada") == "particionada";
+    const bool texto_por_nodo = leer_opcion(argc, argv, "texto", "nodo") == "nodo";
+
+    ContenidoArchivo archivo_texto;
+    unique_ptr<MemoriaNodo> texto_nodo; // se libera antes de MPI_Finalize
     vector<string> lista_patrones;
-    bool carga_texto_exitosa = cargar_contenido_archivo("texto.txt", contenido_texto);
+    string_view contenido_texto;
+    bool carga_texto_exitosa = true;
+    if (particionada) {
+        // cada proceso lee su bloque mas adelante
+    } else if (texto_por_nodo) {
+        // Solo el proceso 0 necesita el archivo; a los otros nodos va una vez, entre lideres
+        long long longitud = -1;
+        ContenidoArchivo archivo_raiz;
+        if (rank == 0 && cargar_contenido_archivo("texto.txt", archivo_raiz)) longitud = (long long)archivo_raiz.vista.size();
+        MPI_Bcast(&longitud, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+        carga_texto_exitosa = longitud >= 0;
+        if (carga_texto_exitosa) {
+            texto_nodo = make_unique<MemoriaNodo>(size_t(longitud));
+            if (rank == 0) memcpy(texto_nodo->datos(), archivo_raiz.vista.data(), size_t(longitud));
+            texto_nodo->difundir_entre_nodos();
+            texto_nodo->sincronizar();
+            contenido_texto = string_view(texto_nodo->datos(), size_t(longitud));
+        }
+    } else {
+        carga_texto_exitosa = cargar_contenido_archivo("texto.txt", archivo_texto);
+        contenido_texto = archivo_texto.vista;
+    }
     bool carga_patrones_exitosa = cargar_patrones_desde_archivo("patrones.txt", lista_patrones);
 
     int estado_local = (carga_texto_exitosa && carga_patrones_exitosa) ? 1 : 0;
@@ -94,64 +354,169 @@ int main(int argc, char** argv) {
     
     if (!estado_global) {
         if (rank == 0) {
-            cerr << "Error: no se pudo leer texto.txt o patrones.txt en todos los procesos\n";
+            cerr << "Error: no se pudo leer texto.txt o patrones.txt\n";
         }
+        texto_nodo.reset();
         MPI_Finalize();
         return 1;
     }
 
     const int total_patrones = (int)lista_patrones.size();
-    int patrones_por_proceso = total_patrones / size;
-    int patrones_restantes = total_patrones % size;
-    int indice_inicio = rank * patrones_por_proceso + min(rank, patrones_restantes);
-    int cantidad_patrones = patrones_por_proceso + (rank < patrones_restantes ? 1 : 0);
-    int indice_fin = indice_inicio + cantidad_patrones;
 
+    // Identidad de cada proceso: se junta una sola vez, al principio
     string mi_direccion_ip = conseguir_direccion_ip();
     char nombre_host[MPI_MAX_PROCESSOR_NAME];
     int longitud_nombre = 0;
     MPI_Get_processor_name(nombre_host, &longitud_nombre);
 
-    MPI_Barrier(MPI_COMM_WORLD);
-    timeval inicio_tiempo{}, fin_tiempo{};
-    if (rank == 0) gettimeofday(&inicio_tiempo, nullptr);
-
-    vector<int> conteos_locales(total_patrones, -1);
-    vector<int> propietarios_locales(total_patrones, -1);
-    
-    for (int idx = indice_inicio; idx < indice_fin; ++idx) {
-        int cantidad = contar_ocurrencias_con_solapamiento(contenido_texto, lista_patrones[idx]);
-        conteos_locales[idx] = cantidad;
-        propietarios_locales[idx] = rank;
-    }
-
-    vector<int> conteos_globales(total_patrones, 0);
-    vector<int> propietarios_globales(total_patrones, 0);
-    MPI_Reduce(conteos_locales.data(), conteos_globales.data(), total_patrones, MPI_INT, MPI_MAX, 0, MPI_COMM_WORLD);
-    MPI_Reduce(propietarios_locales.data(), propietarios_globales.data(), total_patrones, MPI_INT, MPI_MAX, 0, MPI_COMM_WORLD);
-
     const int LONGITUD_IP = 64;
     char buffer_ip[LONGITUD_IP];
     memset(buffer_ip, 0, sizeof(buffer_ip));
     snprintf(buffer_ip, LONGITUD_IP, "%s", mi_direccion_ip.c_str());
-    
-    vector<char> todas_las_ips;
-    todas_las_ips.resize(size * LONGITUD_IP, 0);
+
+    vector<char> todas_las_ips(size * LONGITUD_IP, 0);
     MPI_Gather(buffer_ip, LONGITUD_IP, MPI_CHAR, todas_las_ips.data(), LONGITUD_IP, MPI_CHAR, 0, MPI_COMM_WORLD);
+    vector<string> mapa_rank_ip(size);
+    if (rank == 0) {
+        for (int proceso = 0; proceso < size; ++proceso) {
+            mapa_rank_ip[proceso] = string(&todas_las_ips[proceso * LONGITUD_IP]);
+        }
+    }
+
+    if (modo == "bloques") {
+        // Con lectura particionada el archivo se abre con MPI-IO y cada proceso lee
+        // su bloque mas un halo de (largo del patron mas largo - 1) bytes, para las
+        // ocurrencias que empiezan en el bloque y terminan en el siguiente
+        MPI_File archivo_mpi = MPI_FILE_NULL;
+        MPI_Offset tamanio_archivo = (MPI_Offset)contenido_texto.size();
+        if (particionada) {
+            int error_apertura = MPI_File_open(MPI_COMM_WORLD, "texto.txt", MPI_MODE_RDONLY, MPI_INFO_NULL, &archivo_mpi);
+            if (error_apertura != MPI_SUCCESS || MPI_File_get_size(archivo_mpi, &tamanio_archivo) != MPI_SUCCESS) {
+                if (rank == 0) cerr << "Error: no se pudo abrir texto.txt con MPI-IO\n";
+                MPI_Finalize();
+                return 1;
+            }
+        }
+
+        const size_t longitud_texto = (size_t)tamanio_archivo;
+        size_t bytes_por_proceso = longitud_texto / size;
+        size_t bytes_restantes = longitud_texto % size;
+        size_t byte_inicio = rank * bytes_por_proceso + min<size_t>(rank, bytes_restantes);
+        size_t byte_fin = byte_inicio + bytes_por_proceso + (size_t(rank) < bytes_restantes ? 1 : 0);
+
+        // texto_bloque empieza en el byte `base` del archivo
+        string bloque_leido;
+        string_view texto_bloque = contenido_texto;
+        size_t base = 0;
+        double tiempo_lectura = 0;
+        if (particionada) {
+            size_t largo_maximo = 1;
+            for (const string& patron : lista_patrones) largo_maximo = max(largo_maximo, patron.size());
+            size_t fin_con_halo = min(longitud_texto, byte_fin + largo_maximo - 1);
+
+            double t0 = MPI_Wtime();
+            int lectura_ok = leer_rango_colectivo(archivo_mpi, byte_inicio, fin_con_halo, bloque_leido) ? 1 : 0;
+            MPI_File_close(&archivo_mpi);
+            tiempo_lectura = MPI_Wtime() - t0;
+            MPI_Allreduce(MPI_IN_PLACE, &lectura_ok, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+            MPI_Allreduce(MPI_IN_PLACE, &tiempo_lectura, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+            if (!lectura_ok) {
+                if (rank == 0) cerr << "Error: fallo la lectura de texto.txt con MPI_File_read_at_all\n";
+                MPI_Finalize();
+                return 1;
+            }
+            texto_bloque = bloque_leido;
+            base = byte_inicio;
+        }
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        timeval inicio_tiempo{}, fin_tiempo{};
+        if (rank == 0) gettimeofday(&inicio_tiempo, nullptr);
+
+        // El bloque del proceso se vuelve a partir en sub-bloques para sus hilos
+        // (varios por hilo para balancear); cada sub-bloque cuenta todos los patrones.
+        const size_t sub_bloques = max<size_t>(1, min<size_t>(4 * pool.cantidad_hilos(), byte_fin - byte_inicio));
+        const size_t bytes_sub_bloque = (byte_fin - byte_inicio + sub_bloques - 1) / sub_bloques;
+        vector<long long> conteos_locales = pool.parallel_reduce(
+            0, sub_bloques, 1, vector<long long>(total_patrones, 0),
+            [&](size_t s, size_t) {
+                vector<long long> conteos(total_patrones, 0);
+                size_t desde = min(byte_fin, byte_inicio + s * bytes_sub_bloque);
+                size_t hasta = min(byte_fin, desde + bytes_sub_bloque);
+                for (int idx = 0; idx < total_patrones; ++idx)
+                    conteos[idx] = contar_ocurrencias_en_rango(texto_bloque, lista_patrones[idx], desde - base, hasta - base);
+                return conteos;
+            },
+            [](vector<long long> total, const vector<long long>& parcial) {
+                for (size_t idx = 0; idx < total.size(); ++idx) total[idx] += parcial[idx];
+                return total;
+            });
+
+        vector<long long> conteos_globales(total_patrones, 0);
+        MPI_Reduce(conteos_locales.data(), conteos_globales.data(), total_patrones, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+        if (rank == 0) {
+            gettimeofday(&fin_tiempo, nullptr);
+            double duracion_total = (fin_tiempo.tv_sec - inicio_tiempo.tv_sec) +
+                                   (fin_tiempo.tv_usec - inicio_tiempo.tv_usec)/1e6;
+
+            for (int indice = 0; indice < total_patrones; ++indice) {
+                cout << "el patron " << indice << " aparece " << conteos_globales[indice]
+                     << " veces. Buscado por " << size << " procesos x " << pool.cantidad_hilos()
+                     << " hilos (texto dividido en bloques)\n";
+            }
+            if (particionada)
+                cout << "Lectura del texto: cada proceso leyo solo su bloque con MPI-IO ("
+                     << fixed << setprecision(6) << tiempo_lectura << " segundos)\n";
+
+            cout << fixed << setprecision(6);
+            cout << "Tiempo de ejecucion (MPI): " << duracion_total << " segundos\n";
+        }
+
+        texto_nodo.reset();
+        MPI_Finalize();
+        return 0;
+    }
+
+    // --reparto=dinamico: lotes de patrones pedidos a un contador RMA (por defecto)
+    // --reparto=estatico: tramos contiguos fijos por proceso
+    // --lote=N: patrones por pedido en el reparto dinamico (por defecto, los hilos del proceso)
+    const string reparto = leer_opcion(argc, argv, "reparto", "dinamico");
+    const int lote = max(1, stoi(leer_opcion(argc, argv, "lote", to_string(pool.cantidad_hilos()))));
+    if (reparto != "dinamico" && reparto != "estatico") {
+        if (rank == 0) cerr << "Reparto desconocido: " << reparto << " (dinamico|estatico)\n";
+        texto_nodo.reset();
+        MPI_Finalize();
+        return 1;
+    }
+
+    MPI_Datatype tipo_registro = tipo_registro_patron();
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    timeval inicio_tiempo{}, fin_tiempo{};
+    if (rank == 0) gettimeofday(&inicio_tiempo, nullptr);
+    double inicio_busqueda = MPI_Wtime();
+
+    ResultadoPatrones resultado = reparto == "dinamico"
+                                      ? buscar_patrones_dinamico(pool, contenido_texto, lista_patrones, rank, lote, tipo_registro)
+                                      : buscar_patrones_estatico(pool, contenido_texto, lista_patrones, rank, size, tipo_registro);
+
+    // Inactivo: desde el inicio hasta que termina el ultimo proceso, menos lo que estuvo contando
+    MPI_Barrier(MPI_COMM_WORLD);
+    double carga_local[4] = {resultado.ocupado, MPI_Wtime() - inicio_busqueda - resultado.ocupado,
+                             (double)resultado.patrones, (double)resultado.lotes};
+    vector<double> carga_procesos(4 * size);
+    MPI_Gather(carga_local, 4, MPI_DOUBLE, carga_procesos.data(), 4, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Type_free(&tipo_registro);
 
     if (rank == 0) {
         gettimeofday(&fin_tiempo, nullptr);
         double duracion_total = (fin_tiempo.tv_sec - inicio_tiempo.tv_sec) + 
                                (fin_tiempo.tv_usec - inicio_tiempo.tv_usec)/1e6;
 
-        vector<string> mapa_rank_ip(size);
-        for (int proceso = 0; proceso < size; ++proceso) {
-            mapa_rank_ip[proceso] = string(&todas_las_ips[proceso * LONGITUD_IP]);
-        }
-
         for (int indice = 0; indice < total_patrones; ++indice) {
-            int conteo = conteos_globales[indice] < 0 ? 0 : conteos_globales[indice];
-            int propietario = propietarios_globales[indice];
+            uint64_t conteo = resultado.registros[indice].conteo;
+            int propietario = resultado.registros[indice].proceso;
             string ip_procesador = (propietario >= 0 && propietario < size) ? 
                                    mapa_rank_ip[propietario] : "0.0.0.0";
             cout << "el patron " << indice << " aparece " << conteo 
@@ -160,7 +525,17 @@ int main(int argc, char** argv) {
 
         cout << fixed << setprecision(6);
         cout << "Tiempo de ejecucion (MPI): " << duracion_total << " segundos\n";
+
+        cout << "Carga por proceso (reparto " << reparto << "):\n";
+        for (int proceso = 0; proceso < size; ++proceso) {
+            const double* carga = &carga_procesos[4 * proceso];
+            cout << "  proceso " << proceso << " (" << mapa_rank_ip[proceso] << "): " << (long long)carga[2]
+                 << " patrones en " << (long long)carga[3] << " lotes, ocupado " << carga[0]
+                 << " s, inactivo " << carga[1] << " s\n";
+        }
     }
 
+    texto_nodo.reset();
     MPI_Finalize();
-    return 0;
\ No newline at end of file
+    return 0;
+}
@@ -4,8 +4,14 @@
 #include <unistd.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include "reduccion_mpi.h"
+#include "hibrido.h"
+#include "fuente_datos.h"
+#include "producto_punto.h"
 using namespace std;
 
+static const long long BLOQUE_PRODUCTO = 1LL << 16; // elementos por bloque: fijo, no depende de los procesos
+
 static string detectar_ip_local() {
     int descriptor_socket = ::socket(AF_INET, SOCK_DGRAM, 0);
     if (descriptor_socket < 0) return "0.0.0.0";
@@ -34,13 +40,46 @@ static string detectar_ip_local() {
 }
 
 int main(int argc, char** argv) {
-    MPI_Init(&argc, &argv);
+    unsigned hilos = iniciar_mpi_hibrido(&argc, &argv); // MPI_THREAD_FUNNELED + --hilos=N por proceso
+    PoolHilos pool(hilos);
 
     int rank = 0, size = 1;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
     long long dimension_vectores = 100000000LL;
+    string politica = "ingenua"; // --suma=ingenua|kahan|pares|doble
+    // --entrada-a=, --entrada-b=: analitica (por defecto) | archivo:RUTA | fragmentos:PREFIJO
+    string entrada_A = "analitica", entrada_B = "analitica";
+    string nombre_kernel = "auto"; // --kernel=auto|avx512|avx2|escalar
+    // --datos=fusionado: los terminos de entradas analiticas se generan en el
+    // kernel, sin arreglos (por defecto si ambas lo son); --datos=arreglos los
+    // materializa como con cualquier otra fuente
+    string modo_datos;
+    bool sin_cache = false; // --sin-cache: prefetch no temporal al recorrer los arreglos
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.rfind("--suma=", 0) == 0) politica = arg.substr(7);
+        if (arg.rfind("--kernel=", 0) == 0) nombre_kernel = arg.substr(9);
+        if (arg.rfind("--datos=", 0) == 0) modo_datos = arg.substr(8);
+        if (arg == "--sin-cache") sin_cache = true;
+        if (arg.rfind("--entrada-a=", 0) == 0) entrada_A = arg.substr(12);
+        if (arg.rfind("--entrada-b=", 0) == 0) entrada_B = arg.substr(12);
+    }
+    if (!politica_suma_valida(politica)) {
+        if (rank == 0) cerr << "Politica de suma desconocida: " << politica << " (ingenua|kahan|pares|doble)" << endl;
+        MPI_Finalize();
+        return 1;
+    }
+    const bool entradas_analiticas = entrada_A == "analitica" && entrada_B == "analitica";
+    if (modo_datos.empty()) modo_datos = entradas_analiticas ? "fusionado" : "arreglos";
+    if ((modo_datos != "fusionado" && modo_datos != "arreglos") || (modo_datos == "fusionado" && !entradas_analiticas)) {
+        if (rank == 0) cerr << "--datos=fusionado|arreglos (fusionado solo con entradas analiticas)" << endl;
+        MPI_Finalize();
+        return 1;
+    }
+    const bool fusionado = modo_datos == "fusionado";
+    const producto_punto::Kernel kernel = producto_punto::elegir_kernel(nombre_kernel.c_str());
     
     if (rank == 0) {
         cout << "=== Producto Escalar de Vectores con MPI ===" << endl;
@@ -60,24 +99,43 @@ int main(int argc, char** argv) {
     int longitud_nombre = 0;
     MPI_Get_processor_name(nombre_procesador, &longitud_nombre);
 
+    // Cada proceso toma un rango contiguo de bloques enteros
     long long elementos_base = dimension_vectores / size;
-    long long elementos_sobrantes  = dimension_vectores % size;
-    long long indice_comienzo = rank * elementos_base + min<long long>(rank, elementos_sobrantes);
-    long long cantidad_elementos  = elementos_base + (rank < elementos_sobrantes ? 1 : 0);
-    long long indice_termino   = indice_comienzo + cantidad_elementos;
+    RangoBloques rango = repartir_bloques(dimension_vectores, BLOQUE_PRODUCTO, rank, size);
+    long long indice_comienzo = rango.inicio;
+    long long cantidad_elementos  = rango.fin - rango.inicio;
+
+    // Cada proceso genera o lee solo su tramo de los vectores (una matriz de 1 fila)
+    auto valor_A = [](size_t, size_t j) { return (double)(j + 1); };
+    auto valor_B = [dimension_vectores](size_t, size_t j) { return (double)(dimension_vectores - (long long)j); };
+    unique_ptr<FuenteDatos> fuente_A = crear_fuente(entrada_A, 1, dimension_vectores, rank, fuente_analitica(valor_A));
+    unique_ptr<FuenteDatos> fuente_B = crear_fuente(entrada_B, 1, dimension_vectores, rank, fuente_analitica(valor_B));
+    int fuentes_ok = fuente_A && fuente_B;
+    MPI_Allreduce(MPI_IN_PLACE, &fuentes_ok, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (!fuentes_ok) {
+        MPI_Finalize();
+        return 1;
+    }
 
-    vector<double> vector_A_local(cantidad_elementos);
-    vector<double> vector_B_local(cantidad_elementos);
-    
-    for (long long idx = 0; idx < cantidad_elementos; ++idx) {
-        long long posicion_global = indice_comienzo + idx;
-        vector_A_local[idx] = (double)(posicion_global + 1);
-        vector_B_local[idx] = (double)(dimension_vectores - posicion_global);
+    // Las mismas funciones como progresiones para el kernel fusionado: a_j = j + 1, b_j = n - j
+    const producto_punto::Afin afin_A{1.0, 1.0}, afin_B{(double)dimension_vectores, -1.0};
+
+    vector<double> vector_A_local(fusionado ? 0 : cantidad_elementos);
+    vector<double> vector_B_local(fusionado ? 0 : cantidad_elementos);
+    if (!fusionado && (!leer_bloque_paralelo(pool, *fuente_A, 0, 1, indice_comienzo, cantidad_elementos, vector_A_local.data()) ||
+                       !leer_bloque_paralelo(pool, *fuente_B, 0, 1, indice_comienzo, cantidad_elementos, vector_B_local.data()))) {
+        cerr << "Proceso " << rank << ": las fuentes no tienen el tramo [" << indice_comienzo << ", "
+             << indice_comienzo + cantidad_elementos << ")" << endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
     }
 
     if (rank == 0) {
         cout << "Tamaño de vectores: " << dimension_vectores << endl;
-        cout << "Número de procesos: " << size << endl;
+        cout << "Número de procesos: " << size << " (" << pool.cantidad_hilos() << " hilos por proceso)" << endl;
+        cout << "Política de suma: " << politica << endl;
+        cout << "Entradas: A " << fuente_A->descripcion() << ", B " << fuente_B->descripcion() << endl;
+        cout << "Kernel: " << kernel.nombre << ", datos " << modo_datos
+             << (fusionado ? " (sin arreglos)" : sin_cache ? " (prefetch no temporal)" : "") << endl;
         cout << "Elementos por proceso (aproximado): " << elementos_base << endl;
     }
 
@@ -85,13 +143,41 @@ int main(int argc, char** argv) {
     timeval tiempo_inicio{}, tiempo_final{};
     if (rank == 0) gettimeofday(&tiempo_inicio, nullptr);
 
-    double resultado_parcial = 0.0;
-    for (long long idx = 0; idx < cantidad_elementos; ++idx) {
-        resultado_parcial += vector_A_local[idx] * vector_B_local[idx];
-    }
-
-    double resultado_total = 0.0;
-    MPI_Reduce(&resultado_parcial, &resultado_total, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    // Un parcial por bloque; la raiz los combina en orden de bloque, asi el
+    // resultado no depende de la cantidad de procesos (si del kernel: cada uno
+    // suma el bloque en otro orden). Ingenua y kahan usan los kernels SIMD de
+    // producto_punto.h; pares y doble, el bucle escalar con agregar.
+    double resultado_parcial = 0.0, resultado_total = 0.0;
+    con_politica_suma(politica, [&](auto p) {
+        using Politica = decltype(p);
+        // Los bloques del proceso se reparten entre sus hilos; cada uno escribe su parcial
+        vector<Politica> parciales(size_t((cantidad_elementos + BLOQUE_PRODUCTO - 1) / BLOQUE_PRODUCTO));
+        pool.parallel_for(0, parciales.size(), 1, [&](size_t a, size_t b) {
+            for (size_t i = a; i < b; ++i) {
+                long long ini = (long long)i * BLOQUE_PRODUCTO;
+                long long fin = min(cantidad_elementos, ini + BLOQUE_PRODUCTO);
+                constexpr bool ingenua = is_same_v<Politica, SumaIngenua<double>>;
+                if constexpr (ingenua || is_same_v<Politica, SumaKahan<double>>) {
+                    auto f_afin = ingenua ? kernel.afin : kernel.afin_compensado;
+                    auto f_arreglos = ingenua ? kernel.arreglos : kernel.arreglos_compensado;
+                    producto_punto::Parcial bloque =
+                        fusionado ? f_afin(afin_A, afin_B, indice_comienzo + ini, indice_comienzo + fin)
+                                  : f_arreglos(&vector_A_local[ini], &vector_B_local[ini], size_t(fin - ini), sin_cache);
+                    parciales[i].suma = bloque.suma;
+                    if constexpr (!ingenua) parciales[i].compensacion = bloque.compensacion;
+                } else if (fusionado) {
+                    for (long long idx = indice_comienzo + ini; idx < indice_comienzo + fin; ++idx)
+                        parciales[i].agregar(afin_A.en(idx) * afin_B.en(idx));
+                } else {
+                    for (long long idx = ini; idx < fin; ++idx) parciales[i].agregar(vector_A_local[idx] * vector_B_local[idx]);
+                }
+            }
+        });
+        Politica del_proceso;
+        for (const Politica& bloque : parciales) del_proceso.combinar(bloque);
+        resultado_parcial = del_proceso.valor();
+        resultado_total = combinar_bloques_en_orden(parciales, 0, MPI_COMM_WORLD).valor();
+    });
 
     const int TAM_BUFFER_IP = 64;
     char buffer_mi_ip[TAM_BUFFER_IP]; 
@@ -132,11 +218,14 @@ int main(int argc, char** argv) {
         cout << scientific << setprecision(10);
         cout << "A · B = " << resultado_total << endl;
         
-        double valor_esperado = (double)dimension_vectores * (dimension_vectores + 1.0) * (dimension_vectores + 2.0) / 6.0;
-        cout << "Valor esperado: " << valor_esperado << endl;
-        double porcentaje_error = abs(resultado_total - valor_esperado) / valor_esperado * 100.0;
-        cout << fixed << setprecision(6);
-        cout << "Error relativo: " << porcentaje_error << "%" << endl;
+        // El valor cerrado solo vale para las entradas analiticas
+        if (entradas_analiticas) {
+            double valor_esperado = (double)dimension_vectores * (dimension_vectores + 1.0) * (dimension_vectores + 2.0) / 6.0;
+            cout << "Valor esperado: " << valor_esperado << endl;
+            double porcentaje_error = abs(resultado_total - valor_esperado) / valor_esperado * 100.0;
+            cout << fixed << setprecision(6);
+            cout << "Error relativo: " << porcentaje_error << "%" << endl;
+        }
 
         cout << "\n=== Tiempo de Ejecución ===" << endl;
         cout << "Tiempo total (MPI): " << tiempo_ejecucion << " segundos" << endl;
@@ -151,4 +240,8 @@ int main(int argc, char** argv) {
 
 // Compilar: mpicxx -O3 -march=native -o ej3.out ej3.cpp
 // Ejecutar local: mpirun -n 4 ./ej3.out
+// Hibrido (un proceso por nodo): mpirun -n 2 --map-by ppr:1:node --bind-to none ./ej3.out --hilos=8
+// Politica de suma: mpirun -n 4 ./ej3.out --suma=kahan   (ingenua|kahan|pares|doble)
+// Kernel: mpirun -n 4 ./ej3.out --kernel=avx2 --datos=arreglos   (auto|avx512|avx2|escalar; fusionado|arreglos)
+// Vectores en archivos: mpirun -n 4 ./ej3.out --entrada-a=archivo:a.bin --entrada-b=archivo:b.bin --sin-cache
 // Ejecutar en cluster: mpirun -n 8 --hostfile machinesfile.txt ./ej3.out
\ No newline at end of file
@@ -4,44 +4,424 @@
 #include <unistd.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include "hibrido.h"
+#include "fuente_datos.h"
+#include "memoria_nodo.h"
 using namespace std;
 
 static string obtener_direccion_ip() {
     int socket_descriptor = ::socket(AF_INET, SOCK_DGRAM, 0);
     if (socket_descriptor < 0) return "0.0.0.0";
-    
+
     sockaddr_in dest{};
     dest.sin_family = AF_INET;
     dest.sin_port = htons(53);
     ::inet_pton(AF_INET, "1.1.1.1", &dest.sin_addr);
-    
-    if (::connect(socket_descriptor, (sockaddr*)&dest, sizeof(dest)) < 0) { 
-        ::close(socket_descriptor); 
-        return "0.0.0.0"; 
+
+    if (::connect(socket_descriptor, (sockaddr*)&dest, sizeof(dest)) < 0) {
+        ::close(socket_descriptor);
+        return "0.0.0.0";
     }
-    
-    sockaddr_in direccion_local{}; 
+
+    sockaddr_in direccion_local{};
     socklen_t longitud = sizeof(direccion_local);
-    if (::getsockname(socket_descriptor, (sockaddr*)&direccion_local, &longitud) < 0) { 
-        ::close(socket_descriptor); 
-        return "0.0.0.0"; 
+    if (::getsockname(socket_descriptor, (sockaddr*)&direccion_local, &longitud) < 0) {
+        ::close(socket_descriptor);
+        return "0.0.0.0";
     }
-    
+
     ::close(socket_descriptor);
     char buffer[INET_ADDRSTRLEN] = {0};
     const char* ip_string = ::inet_ntop(AF_INET, &direccion_local.sin_addr, buffer, sizeof(buffer));
     return ip_string ? string(ip_string) : "0.0.0.0";
 }
 
+// ---------------------- Reparto y bloques ----------------------
+
+// Reparto equilibrado de n indices en `partes`: la parte p empieza en
+// inicio_parte(n, partes, p) y tiene cantidad_parte(n, partes, p) indices.
+static int inicio_parte(int n, int partes, int p) { return p * (n / partes) + min(p, n % partes); }
+static int cantidad_parte(int n, int partes, int p) { return n / partes + (p < n % partes ? 1 : 0); }
+
+// Parte a la que pertenece el indice i (inversa de inicio_parte).
+static int parte_de(int n, int partes, int i) {
+    int base = n / partes, resto = n % partes;
+    if (i < resto * (base + 1)) return i / (base + 1);
+    return resto + (i - resto * (base + 1)) / base;
+}
+
+// Bloque [fila0, fila0 + filas) x [col0, col0 + cols) de una matriz de N x N.
+struct Bloque {
+    int fila0 = 0, filas = 0, col0 = 0, cols = 0;
+    size_t elementos() const { return size_t(filas) * cols; }
+};
+
+static void copiar_bloque(const vector<double>& completa, int n, const Bloque& b, double* bloque) {
+    for (int i = 0; i < b.filas; ++i)
+        memcpy(bloque + size_t(i) * b.cols, completa.data() + size_t(b.fila0 + i) * n + b.col0, b.cols * sizeof(double));
+}
+
+static void pegar_bloque(vector<double>& completa, int n, const Bloque& b, const double* bloque) {
+    for (int i = 0; i < b.filas; ++i)
+        memcpy(completa.data() + size_t(b.fila0 + i) * n + b.col0, bloque + size_t(i) * b.cols, b.cols * sizeof(double));
+}
+
+// Desplazamientos y cantidades (en doubles) de los bloques empaquetados uno tras
+// otro en orden de rank, como los esperan MPI_Scatterv / MPI_Gatherv.
+static void cuentas_de(const vector<Bloque>& bloques, vector<int>& cantidades, vector<int>& desplazamientos) {
+    cantidades.resize(bloques.size());
+    desplazamientos.resize(bloques.size());
+    int acumulado = 0;
+    for (size_t p = 0; p < bloques.size(); ++p) {
+        cantidades[p] = (int)bloques[p].elementos();
+        desplazamientos[p] = acumulado;
+        acumulado += cantidades[p];
+    }
+}
+
+// La raiz empaqueta el bloque de cada proceso y los reparte con un MPI_Scatterv.
+// Si los bloques son franjas de filas completas ya estan contiguos en orden de
+// rank y se envian directo desde la matriz.
+static vector<double> repartir_desde_raiz(int n, const vector<double>& completa, const vector<Bloque>& bloques,
+                                          int rank, MPI_Comm comm) {
+    vector<int> cantidades, desplazamientos;
+    cuentas_de(bloques, cantidades, desplazamientos);
+    vector<double> local(bloques[rank].elementos());
+
+    const double* origen = nullptr;
+    vector<double> empaquetado;
+    if (rank == 0) {
+        bool filas_completas = all_of(bloques.begin(), bloques.end(), [&](const Bloque& b) { return b.cols == n; });
+        if (filas_completas) {
+            origen = completa.data();
+        } else {
+            empaquetado.resize(size_t(n) * n);
+            for (size_t p = 0; p < bloques.size(); ++p) copiar_bloque(completa, n, bloques[p], empaquetado.data() + desplazamientos[p]);
+            origen = empaquetado.data();
+        }
+    }
+    MPI_Scatterv(origen, cantidades.data(), desplazamientos.data(), MPI_DOUBLE,
+                 local.data(), (int)local.size(), MPI_DOUBLE, 0, comm);
+    return local;
+}
+
+// Inversa de repartir_desde_raiz: MPI_Gatherv de los bloques y la raiz los pega en la matriz.
+static vector<double> recolectar_en_raiz(int n, const vector<double>& local, const vector<Bloque>& bloques,
+                                         int rank, MPI_Comm comm) {
+    vector<int> cantidades, desplazamientos;
+    cuentas_de(bloques, cantidades, desplazamientos);
+    vector<double> empaquetado, completa;
+    if (rank == 0) empaquetado.resize(size_t(n) * n);
+    MPI_Gatherv(local.data(), (int)local.size(), MPI_DOUBLE,
+                empaquetado.data(), cantidades.data(), desplazamientos.data(), MPI_DOUBLE, 0, comm);
+    if (rank == 0) {
+        bool filas_completas = all_of(bloques.begin(), bloques.end(), [&](const Bloque& b) { return b.cols == n; });
+        if (filas_completas) return empaquetado;
+        completa.resize(size_t(n) * n);
+        for (size_t p = 0; p < bloques.size(); ++p) pegar_bloque(completa, n, bloques[p], empaquetado.data() + desplazamientos[p]);
+    }
+    return completa;
+}
+
+// C (filas x columnas) += A (filas x prof) * B (prof x columnas), las tres por
+// filas con paso lda/ldb/ldc. Orden i-k-j (B y C se recorren por filas) y las
+// filas de C repartidas entre los hilos del proceso.
+static void acumular_producto(PoolHilos& pool, int filas, int columnas, int prof,
+                              const double* A, int lda, const double* B, int ldb, double* C, int ldc) {
+    size_t grano = max<size_t>(1, size_t(filas) / (4 * pool.cantidad_hilos()));
+    pool.parallel_for(0, filas, grano, [&](size_t fila_ini, size_t fila_fin) {
+        for (size_t i = fila_ini; i < fila_fin; ++i) {
+            double* c = C + i * ldc;
+            for (int k = 0; k < prof; ++k) {
+                const double a = A[i * lda + k];
+                const double* b = B + size_t(k) * ldb;
+                for (int j = 0; j < columnas; ++j) c[j] += a * b[j];
+            }
+        }
+    });
+}
+
+// Entradas A y B. Con reparto local cada proceso lee de las fuentes solo sus
+// bloques; con reparto desde la raiz (fuentes en nullptr) el proceso 0 tiene
+// las matrices completas y las reparte.
+struct Entradas {
+    const FuenteDatos* fuente_A = nullptr;
+    const FuenteDatos* fuente_B = nullptr;
+    vector<double> completa_A, completa_B;
+};
+
+// Bloque propio de una entrada, leido de la fuente o recibido de la raiz.
+static vector<double> bloque_de_entrada(PoolHilos& pool, int n, const FuenteDatos* fuente, const vector<double>& completa,
+                                        const vector<Bloque>& bloques, int rank) {
+    if (!fuente) return repartir_desde_raiz(n, completa, bloques, rank, MPI_COMM_WORLD);
+    const Bloque& b = bloques[rank];
+    vector<double> local(b.elementos());
+    if (!leer_bloque_paralelo(pool, *fuente, b.fila0, b.filas, b.col0, b.cols, local.data())) {
+        cerr << "Proceso " << rank << ": " << fuente->descripcion() << " no tiene el bloque pedido" << endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return local;
+}
+
+// Paneles de k: las difusiones se hacen de a franjas de a lo sumo ANCHO_PANEL
+// para poder multiplicar una mientras llega la siguiente.
+static const int ANCHO_PANEL = 128;
+
+// Tiempos del proceso (MPI_Wtime): lectura o reparto inicial de A (y B salvo
+// en filas desde la raiz) y producto, que incluye las difusiones de paneles.
+struct Tiempos {
+    double reparto = 0, producto = 0;
+};
+
+// ---------------------- Por filas: A repartida, B replicada ----------------------
+//
+// Con `compartir`, B esta una sola vez por nodo (MemoriaNodo) y los procesos del
+// nodo la leen en el lugar; si no, cada proceso tiene su copia.
+// Con reparto local B se lee de su fuente (con `compartir`, cada proceso del
+// nodo lee una franja de filas) y no hay difusion. Desde la raiz, con `solapar`,
+// B se difunde en franjas de ANCHO_PANEL filas con MPI_Ibcast (todas lanzadas de
+// entrada, solo entre lideres si se comparte) y cada proceso multiplica sus filas
+// de A por la franja k apenas la recibe, mientras las siguientes siguen en camino.
+
+static vector<double> multiplicar_por_filas(int n, int rank, int size, PoolHilos& pool, bool solapar, bool compartir,
+                                            Entradas& entradas, vector<Bloque>& bloques_C, Tiempos& tiempos) {
+    double t0 = MPI_Wtime();
+    bloques_C.resize(size);
+    for (int p = 0; p < size; ++p) bloques_C[p] = Bloque{inicio_parte(n, size, p), cantidad_parte(n, size, p), 0, n};
+    const Bloque& mio = bloques_C[rank];
+
+    // A se reparte como C
+    vector<double> matriz_A_local = bloque_de_entrada(pool, n, entradas.fuente_A, entradas.completa_A, bloques_C, rank);
+    vector<double> matriz_C_local(mio.elementos(), 0.0);
+
+    unique_ptr<MemoriaNodo> memoria_B;
+    double* B = nullptr;
+    if (compartir) {
+        memoria_B = make_unique<MemoriaNodo>(size_t(n) * n * sizeof(double));
+        B = reinterpret_cast<double*>(memoria_B->datos());
+        if (rank == 0 && !entradas.fuente_B) memcpy(B, entradas.completa_B.data(), size_t(n) * n * sizeof(double));
+    } else {
+        entradas.completa_B.resize(size_t(n) * n);
+        B = entradas.completa_B.data();
+    }
+
+    if (entradas.fuente_B) {
+        // Con memoria de nodo cada proceso del nodo lee su franja de filas de B
+        int partes = compartir ? memoria_B->procesos_nodo() : 1, parte = compartir ? memoria_B->rank_nodo() : 0;
+        int fila0 = inicio_parte(n, partes, parte), filas = cantidad_parte(n, partes, parte);
+        if (!leer_bloque_paralelo(pool, *entradas.fuente_B, fila0, filas, 0, n, B + size_t(fila0) * n)) {
+            cerr << "Proceso " << rank << ": " << entradas.fuente_B->descripcion() << " no tiene las filas de B" << endl;
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        if (compartir) memoria_B->sincronizar();
+    }
+    double t1 = MPI_Wtime();
+
+    if (entradas.fuente_B) {
+        acumular_producto(pool, mio.filas, n, n, matriz_A_local.data(), n, B, n, matriz_C_local.data(), n);
+    } else if (!solapar) {
+        if (compartir) {
+            memoria_B->difundir_entre_nodos();
+            memoria_B->sincronizar();
+        } else {
+            MPI_Bcast(B, n * n, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        }
+        acumular_producto(pool, mio.filas, n, n, matriz_A_local.data(), n, B, n, matriz_C_local.data(), n);
+    } else {
+        int paneles = (n + ANCHO_PANEL - 1) / ANCHO_PANEL;
+        vector<MPI_Request> pedidos(paneles);
+        for (int p = 0; p < paneles; ++p) {
+            int k = p * ANCHO_PANEL, ancho = min(ANCHO_PANEL, n - k);
+            if (compartir)
+                pedidos[p] = memoria_B->difundir_entre_nodos_async(size_t(k) * n * sizeof(double), size_t(ancho) * n * sizeof(double));
+            else
+                MPI_Ibcast(B + size_t(k) * n, ancho * n, MPI_DOUBLE, 0, MPI_COMM_WORLD, &pedidos[p]);
+        }
+        for (int p = 0; p < paneles; ++p) {
+            int k = p * ANCHO_PANEL, ancho = min(ANCHO_PANEL, n - k);
+            MPI_Wait(&pedidos[p], MPI_STATUS_IGNORE);
+            if (compartir) memoria_B->sincronizar(); // el lider ya tiene la franja: el nodo la puede leer
+            acumular_producto(pool, mio.filas, n, ancho, matriz_A_local.data() + k, n, B + size_t(k) * n, n,
+                              matriz_C_local.data(), n);
+            // Solo el hilo principal llama a MPI: entre panel y panel empuja las difusiones pendientes
+            int listo = 0;
+            if (p + 1 < paneles) MPI_Testall(paneles - p - 1, pedidos.data() + p + 1, &listo, MPI_STATUSES_IGNORE);
+        }
+    }
+    tiempos.reparto = t1 - t0;
+    tiempos.producto = MPI_Wtime() - t1;
+    return matriz_C_local;
+}
+
+// ---------------------- SUMMA: grilla 2D, A, B y C repartidas ----------------------
+//
+// Los procesos forman una grilla pf x pc (MPI_Dims_create + MPI_Cart_create).
+// El proceso (f, c) guarda:
+//   - C[filas de f, columnas de c]
+//   - A[filas de f, k de c]      (la dimension k de A se reparte entre columnas)
+//   - B[k de f, columnas de c]   (la dimension k de B se reparte entre filas)
+// asi que cada uno tiene O(N^2 / P) de cada matriz. Para cada panel de k, quien
+// tiene esa franja de A la difunde por su fila de la grilla y quien tiene la de
+// B por su columna; cada proceso acumula C_local += panel_A * panel_B. Los
+// paneles se cortan en la union de los cortes de k de A y de B (y a lo sumo
+// ANCHO_PANEL), de modo que cada panel tiene un unico duenio en cada direccion.
+// Con `solapar` el panel siguiente se difunde con MPI_Ibcast (doble buffer)
+// mientras se multiplica el actual.
+
+struct Panel {
+    int k, ancho, duenio_A, duenio_B;
+};
+
+static vector<double> multiplicar_summa(int n, int rank, int size, PoolHilos& pool, bool solapar,
+                                        const Entradas& entradas, vector<Bloque>& bloques_C, Tiempos& tiempos) {
+    double t0 = MPI_Wtime();
+    int dims[2] = {0, 0}, periodos[2] = {0, 0};
+    MPI_Dims_create(size, 2, dims);
+    MPI_Comm grilla, comm_fila, comm_columna;
+    MPI_Cart_create(MPI_COMM_WORLD, 2, dims, periodos, 0, &grilla); // sin reordenar: rank de grilla == rank global
+    int mantener_columna[2] = {0, 1}, mantener_fila[2] = {1, 0};
+    MPI_Cart_sub(grilla, mantener_columna, &comm_fila);   // procesos de mi fila (rank = coordenada de columna)
+    MPI_Cart_sub(grilla, mantener_fila, &comm_columna);   // procesos de mi columna (rank = coordenada de fila)
+
+    // A, B y C usan el mismo corte: filas por la coordenada de fila, columnas por
+    // la de columna (en A las columnas son k, en B las filas son k)
+    const int pf = dims[0], pc = dims[1];
+    bloques_C.resize(size);
+    for (int p = 0; p < size; ++p) {
+        int coords[2];
+        MPI_Cart_coords(grilla, p, 2, coords);
+        bloques_C[p] = Bloque{inicio_parte(n, pf, coords[0]), cantidad_parte(n, pf, coords[0]),
+                              inicio_parte(n, pc, coords[1]), cantidad_parte(n, pc, coords[1])};
+    }
+    const Bloque& mio = bloques_C[rank];
+
+    vector<double> A_local = bloque_de_entrada(pool, n, entradas.fuente_A, entradas.completa_A, bloques_C, rank);
+    vector<double> B_local = bloque_de_entrada(pool, n, entradas.fuente_B, entradas.completa_B, bloques_C, rank);
+    vector<double> C_local(mio.elementos(), 0.0);
+    double t1 = MPI_Wtime();
+
+    int mi_fila = 0, mi_columna = 0;
+    MPI_Comm_rank(comm_columna, &mi_fila);
+    MPI_Comm_rank(comm_fila, &mi_columna);
+
+    vector<Panel> paneles;
+    for (int k = 0; k < n;) {
+        int duenio_A = parte_de(n, pc, k), duenio_B = parte_de(n, pf, k);
+        int fin_A = inicio_parte(n, pc, duenio_A) + cantidad_parte(n, pc, duenio_A);
+        int fin_B = inicio_parte(n, pf, duenio_B) + cantidad_parte(n, pf, duenio_B);
+        int ancho = min({ANCHO_PANEL, fin_A - k, fin_B - k});
+        paneles.push_back(Panel{k, ancho, duenio_A, duenio_B});
+        k += ancho;
+    }
+
+    // Dos juegos de buffers: mientras se multiplica el panel t en uno, el t+1 llega al otro
+    vector<double> panel_A[2], panel_B[2];
+    const double* franja_B[2] = {nullptr, nullptr};
+    MPI_Request pedidos[2][2] = {{MPI_REQUEST_NULL, MPI_REQUEST_NULL}, {MPI_REQUEST_NULL, MPI_REQUEST_NULL}};
+    for (int s = 0; s < 2; ++s) {
+        panel_A[s].resize(size_t(mio.filas) * ANCHO_PANEL);
+        panel_B[s].resize(size_t(ANCHO_PANEL) * mio.cols);
+    }
+
+    auto difundir = [&](const Panel& p, int s) {
+        // Franja de A (mis filas x [k, k + ancho)): la difunde quien la tiene, por la fila
+        if (mi_columna == p.duenio_A) {
+            int desde = p.k - mio.col0;
+            for (int i = 0; i < mio.filas; ++i)
+                memcpy(panel_A[s].data() + size_t(i) * p.ancho, A_local.data() + size_t(i) * mio.cols + desde, p.ancho * sizeof(double));
+        }
+        // Franja de B ([k, k + ancho) x mis columnas): contigua en B_local, por la columna
+        double* destino_B = panel_B[s].data();
+        if (mi_fila == p.duenio_B) destino_B = B_local.data() + size_t(p.k - mio.fila0) * mio.cols;
+        franja_B[s] = destino_B;
+        if (solapar) {
+            MPI_Ibcast(panel_A[s].data(), mio.filas * p.ancho, MPI_DOUBLE, p.duenio_A, comm_fila, &pedidos[s][0]);
+            MPI_Ibcast(destino_B, p.ancho * mio.cols, MPI_DOUBLE, p.duenio_B, comm_columna, &pedidos[s][1]);
+        } else {
+            MPI_Bcast(panel_A[s].data(), mio.filas * p.ancho, MPI_DOUBLE, p.duenio_A, comm_fila);
+            MPI_Bcast(destino_B, p.ancho * mio.cols, MPI_DOUBLE, p.duenio_B, comm_columna);
+        }
+    };
+
+    if (!paneles.empty() && solapar) difundir(paneles[0], 0);
+    for (size_t t = 0; t < paneles.size(); ++t) {
+        int s = int(t % 2);
+        if (solapar) {
+            MPI_Waitall(2, pedidos[s], MPI_STATUSES_IGNORE);
+            if (t + 1 < paneles.size()) difundir(paneles[t + 1], 1 - s);
+        } else {
+            difundir(paneles[t], s);
+        }
+        acumular_producto(pool, mio.filas, mio.cols, paneles[t].ancho, panel_A[s].data(), paneles[t].ancho,
+                          franja_B[s], mio.cols, C_local.data(), mio.cols);
+        int listo = 0;
+        if (solapar) MPI_Testall(2, pedidos[1 - s], &listo, MPI_STATUSES_IGNORE);
+    }
+
+    MPI_Comm_free(&comm_fila);
+    MPI_Comm_free(&comm_columna);
+    MPI_Comm_free(&grilla);
+    tiempos.reparto = t1 - t0;
+    tiempos.producto = MPI_Wtime() - t1;
+    return C_local;
+}
+
+// ---------------------- Programa principal ----------------------
+
 int main(int argc, char** argv) {
-    MPI_Init(&argc, &argv);
+    unsigned hilos = iniciar_mpi_hibrido(&argc, &argv); // MPI_THREAD_FUNNELED + --hilos=N por proceso
+    PoolHilos pool(hilos);
 
     int rank = 0, size = 1;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
+    // --algoritmo=summa: grilla 2D, A, B y C repartidas en bloques (por defecto)
+    // --algoritmo=filas: A repartida por filas, B replicada en todos los procesos
+    // --comunicacion=solapada: difusiones por paneles con MPI_Ibcast, solapadas con el producto (por defecto)
+    // --comunicacion=bloqueante: MPI_Bcast y despues el producto
+    // --recolectar: juntar C completa en el proceso 0 (si no, solo sumas y esquinas)
+    // --entrada-a=, --entrada-b=: analitica (por defecto) | archivo:RUTA | fragmentos:PREFIJO
+    // --reparto=local: cada proceso lee o genera solo sus bloques (por defecto)
+    // --reparto=raiz: el proceso 0 lee las matrices completas y las reparte
+    // --memoria-b=nodo: con --algoritmo=filas, una copia de B por nodo en memoria compartida (por defecto)
+    // --memoria-b=proceso: una copia de B por proceso
+    string algoritmo = "summa", comunicacion = "solapada", reparto = "local", memoria_b = "nodo";
+    string entrada_A = "analitica", entrada_B = "analitica";
+    bool recolectar = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg.rfind("--algoritmo=", 0) == 0) algoritmo = arg.substr(12);
+        if (arg.rfind("--comunicacion=", 0) == 0) comunicacion = arg.substr(15);
+        if (arg == "--recolectar") recolectar = true;
+        if (arg.rfind("--entrada-a=", 0) == 0) entrada_A = arg.substr(12);
+        if (arg.rfind("--entrada-b=", 0) == 0) entrada_B = arg.substr(12);
+        if (arg.rfind("--reparto=", 0) == 0) reparto = arg.substr(10);
+        if (arg.rfind("--memoria-b=", 0) == 0) memoria_b = arg.substr(12);
+    }
+    if (algoritmo != "summa" && algoritmo != "filas") {
+        if (rank == 0) cerr << "Algoritmo desconocido: " << algoritmo << " (summa|filas)" << endl;
+        MPI_Finalize();
+        return 1;
+    }
+    if (comunicacion != "solapada" && comunicacion != "bloqueante") {
+        if (rank == 0) cerr << "Comunicacion desconocida: " << comunicacion << " (solapada|bloqueante)" << endl;
+        MPI_Finalize();
+        return 1;
+    }
+    if (reparto != "local" && reparto != "raiz") {
+        if (rank == 0) cerr << "Reparto desconocido: " << reparto << " (local|raiz)" << endl;
+        MPI_Finalize();
+        return 1;
+    }
+    if (memoria_b != "nodo" && memoria_b != "proceso") {
+        if (rank == 0) cerr << "Memoria de B desconocida: " << memoria_b << " (nodo|proceso)" << endl;
+        MPI_Finalize();
+        return 1;
+    }
+
     int tamano_matriz = 1000;
-    
+
     if (rank == 0) {
         cout << "=== Multiplicacion de Matrices con MPI ===" << endl;
         cout << "Ingrese el tamaño NxN (Enter para usar " << tamano_matriz << "): ";
@@ -54,92 +434,102 @@ int main(int argc, char** argv) {
     }
 
     MPI_Bcast(&tamano_matriz, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    const int n = tamano_matriz;
 
-    string ip_actual = obtener_direccion_ip();
-    char nombre_nodo[MPI_MAX_PROCESSOR_NAME]; 
-    int longitud_nombre_nodo = 0;
-    MPI_Get_processor_name(nombre_nodo, &longitud_nombre_nodo);
+    // Cada elemento de las entradas analiticas depende solo de su indice
+    const size_t columnas = n;
+    auto valor_A = [columnas](size_t i, size_t j) { return (double)((i * columnas + j) % 100); };
+    auto valor_B = [columnas](size_t i, size_t j) { return (double)(((i * columnas + j) * 2) % 100); };
 
-    int filas_base = tamano_matriz / size;
-    int filas_adicionales = tamano_matriz % size;
-    int filas_asignadas = filas_base + (rank < filas_adicionales ? 1 : 0);
-    int fila_inicial = rank * filas_base + min(rank, filas_adicionales);
-
-    vector<double> matriz_A_local(filas_asignadas * tamano_matriz);
-    vector<double> matriz_B(tamano_matriz * tamano_matriz);
-    vector<double> matriz_C_local(filas_asignadas * tamano_matriz);
-
-    if (rank == 0) {
-        vector<double> matriz_A_completa(tamano_matriz * tamano_matriz);
-        for (int idx = 0; idx < tamano_matriz * tamano_matriz; ++idx) {
-            matriz_A_completa[idx] = (double)(idx % 100);
-        }
-        for (int idx = 0; idx < tamano_matriz * tamano_matriz; ++idx) {
-            matriz_B[idx] = (double)((idx * 2) % 100);
-        }
-
-        int desplazamiento = 0;
-        for (int proceso = 0; proceso < size; ++proceso) {
-            int filas_proceso = filas_base + (proceso < filas_adicionales ? 1 : 0);
-            if (proceso == 0) {
-                memcpy(matriz_A_local.data(), matriz_A_completa.data(), filas_asignadas * tamano_matriz * sizeof(double));
-            } else {
-                MPI_Send(matriz_A_completa.data() + desplazamiento, filas_proceso * tamano_matriz, MPI_DOUBLE, proceso, 0, MPI_COMM_WORLD);
-            }
-            desplazamiento += filas_proceso * tamano_matriz;
-        }
-    } else {
-        MPI_Recv(matriz_A_local.data(), filas_asignadas * tamano_matriz, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    // Con reparto local abren las fuentes todos los procesos; desde la raiz, solo el 0
+    const bool reparto_local = reparto == "local";
+    unique_ptr<FuenteDatos> fuente_A, fuente_B;
+    int fuentes_ok = 1;
+    if (reparto_local || rank == 0) {
+        fuente_A = crear_fuente(entrada_A, n, n, rank, fuente_analitica(valor_A));
+        fuente_B = crear_fuente(entrada_B, n, n, rank, fuente_analitica(valor_B));
+        fuentes_ok = fuente_A && fuente_B;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &fuentes_ok, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (!fuentes_ok) {
+        MPI_Finalize();
+        return 1;
     }
 
-    MPI_Bcast(matriz_B.data(), tamano_matriz * tamano_matriz, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    string ip_actual = obtener_direccion_ip();
+    char nombre_nodo[MPI_MAX_PROCESSOR_NAME];
+    int longitud_nombre_nodo = 0;
+    MPI_Get_processor_name(nombre_nodo, &longitud_nombre_nodo);
 
     if (rank == 0) {
-        cout << "Tamaño de matrices: " << tamano_matriz << "x" << tamano_matriz << endl;
-        cout << "Número de procesos: " << size << endl;
-        cout << "Filas por proceso: " << filas_base << " (+" << filas_adicionales << " extra)" << endl;
+        cout << "Tamaño de matrices: " << n << "x" << n << endl;
+        cout << "Número de procesos: " << size << " (" << pool.cantidad_hilos() << " hilos por proceso)" << endl;
+        cout << "Algoritmo: " << algoritmo << ", comunicacion: " << comunicacion
+             << (algoritmo == "filas" ? ", B por " + memoria_b : "")
+             << (recolectar ? ", C recolectada en el proceso 0" : "") << endl;
+        cout << "Entradas: A " << fuente_A->descripcion() << ", B " << fuente_B->descripcion()
+             << " (reparto " << reparto << ")" << endl;
     }
 
+    // El tiempo incluye la lectura y el reparto de A y B y, con --recolectar, la recoleccion de C
     MPI_Barrier(MPI_COMM_WORLD);
     timeval inicio{}, fin{};
     if (rank == 0) gettimeofday(&inicio, nullptr);
 
-    for (int fila = 0; fila < filas_asignadas; ++fila) {
-        for (int columna = 0; columna < tamano_matriz; ++columna) {
-            double suma_productos = 0.0;
-            for (int indice_k = 0; indice_k < tamano_matriz; ++indice_k) {
-                suma_productos += matriz_A_local[fila * tamano_matriz + indice_k] * matriz_B[indice_k * tamano_matriz + columna];
-            }
-            matriz_C_local[fila * tamano_matriz + columna] = suma_productos;
+    Entradas entradas;
+    if (reparto_local) {
+        entradas.fuente_A = fuente_A.get();
+        entradas.fuente_B = fuente_B.get();
+    } else if (rank == 0) {
+        entradas.completa_A.resize(size_t(n) * n);
+        entradas.completa_B.resize(size_t(n) * n);
+        if (!leer_bloque_paralelo(pool, *fuente_A, 0, n, 0, n, entradas.completa_A.data()) ||
+            !leer_bloque_paralelo(pool, *fuente_B, 0, n, 0, n, entradas.completa_B.data())) {
+            cerr << "Proceso 0: las fuentes no tienen las matrices completas" << endl;
+            MPI_Abort(MPI_COMM_WORLD, 1);
         }
     }
 
-    vector<double> matriz_resultado;
-    if (rank == 0) {
-        matriz_resultado.resize(tamano_matriz * tamano_matriz);
-        memcpy(matriz_resultado.data(), matriz_C_local.data(), filas_asignadas * tamano_matriz * sizeof(double));
-        
-        int posicion = filas_asignadas * tamano_matriz;
-        for (int proc = 1; proc < size; ++proc) {
-            int filas_proc = filas_base + (proc < filas_adicionales ? 1 : 0);
-            MPI_Recv(matriz_resultado.data() + posicion, filas_proc * tamano_matriz, MPI_DOUBLE, proc, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            posicion += filas_proc * tamano_matriz;
-        }
-    } else {
-        MPI_Send(matriz_C_local.data(), filas_asignadas * tamano_matriz, MPI_DOUBLE, 0, 1, MPI_COMM_WORLD);
+    const bool solapar = comunicacion == "solapada";
+    vector<Bloque> bloques;
+    Tiempos tiempos;
+    vector<double> C_local = algoritmo == "filas"
+                                 ? multiplicar_por_filas(n, rank, size, pool, solapar, memoria_b == "nodo", entradas, bloques, tiempos)
+                                 : multiplicar_summa(n, rank, size, pool, solapar, entradas, bloques, tiempos);
+    const Bloque& mio = bloques[rank];
+
+    // Lo que se imprime (suma y esquinas) se reduce sin mover C: cada proceso
+    // suma su bloque y aporta las esquinas que le tocan (las demas en -inf)
+    double suma_local = 0.0;
+    for (double valor : C_local) suma_local += valor;
+    double esquinas[4], esquinas_C[4];
+    const int filas_esquina[4] = {0, 0, n - 1, n - 1}, columnas_esquina[4] = {0, n - 1, 0, n - 1};
+    for (int e = 0; e < 4; ++e) {
+        int i = filas_esquina[e] - mio.fila0, j = columnas_esquina[e] - mio.col0;
+        bool es_mia = i >= 0 && i < mio.filas && j >= 0 && j < mio.cols;
+        esquinas[e] = es_mia ? C_local[size_t(i) * mio.cols + j] : -numeric_limits<double>::infinity();
     }
+    MPI_Reduce(esquinas, esquinas_C, 4, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    vector<double> sumas(size);
+    MPI_Gather(&suma_local, 1, MPI_DOUBLE, sumas.data(), 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    double t_recoleccion = MPI_Wtime();
+    vector<double> matriz_resultado;
+    if (recolectar) matriz_resultado = recolectar_en_raiz(n, C_local, bloques, rank, MPI_COMM_WORLD);
+    t_recoleccion = MPI_Wtime() - t_recoleccion;
 
     const int TAMANO_CADENA_IP = 64;
-    char buffer_ip_local[TAMANO_CADENA_IP]; 
+    char buffer_ip_local[TAMANO_CADENA_IP];
     memset(buffer_ip_local, 0, sizeof(buffer_ip_local));
     snprintf(buffer_ip_local, TAMANO_CADENA_IP, "%s", ip_actual.c_str());
-    
-    vector<char> buffer_todas_ips; 
+
+    vector<char> buffer_todas_ips;
     buffer_todas_ips.resize(size * TAMANO_CADENA_IP, 0);
     MPI_Gather(buffer_ip_local, TAMANO_CADENA_IP, MPI_CHAR, buffer_todas_ips.data(), TAMANO_CADENA_IP, MPI_CHAR, 0, MPI_COMM_WORLD);
 
-    vector<int> conteo_filas(size);
-    MPI_Gather(&filas_asignadas, 1, MPI_INT, conteo_filas.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    // Reparto y producto del proceso mas lento
+    double tiempos_max[2], tiempos_locales[2] = {tiempos.reparto, tiempos.producto};
+    MPI_Reduce(tiempos_locales, tiempos_max, 2, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
 
     if (rank == 0) {
         gettimeofday(&fin, nullptr);
@@ -153,26 +543,37 @@ int main(int argc, char** argv) {
         cout << "\n=== Resultados ===" << endl;
         cout << "\nDistribución de trabajo:" << endl;
         for (int id_proceso = 0; id_proceso < size; ++id_proceso) {
+            const Bloque& b = bloques[id_proceso];
             cout << "Proceso " << id_proceso << " (IP: " << ips_procesos[id_proceso] << ")" << endl;
-            cout << "  - Filas procesadas: " << conteo_filas[id_proceso] << endl;
+            cout << "  - Bloque de C: filas [" << b.fila0 << ", " << b.fila0 + b.filas << ") x columnas ["
+                 << b.col0 << ", " << b.col0 + b.cols << ")" << endl;
         }
 
+        // Sumas de bloque combinadas en orden de rank (con --recolectar, la C
+        // completa se verifica contra estos valores)
         double suma_total = 0.0;
-        for (int idx = 0; idx < tamano_matriz * tamano_matriz; ++idx) {
-            suma_total += matriz_resultado[idx];
+        for (double s : sumas) suma_total += s;
+        if (recolectar) {
+            const size_t N = n;
+            const double en_matriz[4] = {matriz_resultado[0], matriz_resultado[N-1], matriz_resultado[(N-1)*N], matriz_resultado[N*N-1]};
+            bool coincide = equal(begin(en_matriz), end(en_matriz), begin(esquinas_C));
+            cout << "\nC recolectada: " << (coincide ? "coincide" : "NO coincide") << " con las esquinas reducidas" << endl;
         }
 
         cout << "\n=== Resultado de C = A x B ===" << endl;
         cout << fixed << setprecision(2);
-        cout << "Esquina superior izquierda: " << matriz_resultado[0] << endl;
-        cout << "Esquina superior derecha: " << matriz_resultado[tamano_matriz-1] << endl;
-        cout << "Esquina inferior izquierda: " << matriz_resultado[(tamano_matriz-1)*tamano_matriz] << endl;
-        cout << "Esquina inferior derecha: " << matriz_resultado[tamano_matriz*tamano_matriz-1] << endl;
+        cout << "Esquina superior izquierda: " << esquinas_C[0] << endl;
+        cout << "Esquina superior derecha: " << esquinas_C[1] << endl;
+        cout << "Esquina inferior izquierda: " << esquinas_C[2] << endl;
+        cout << "Esquina inferior derecha: " << esquinas_C[3] << endl;
         cout << scientific << setprecision(6);
         cout << "Sumatoria total de C: " << suma_total << endl;
 
         cout << "\n=== Tiempo de Ejecución ===" << endl;
         cout << "Tiempo total (MPI): " << tiempo_transcurrido << " segundos" << endl;
+        cout << "  - Lectura y reparto de A y B: " << tiempos_max[0] << " s" << endl;
+        cout << "  - Producto (con difusiones): " << tiempos_max[1] << " s" << endl;
+        if (recolectar) cout << "  - Recoleccion de C: " << t_recoleccion << " s" << endl;
     }
 
     MPI_Finalize();
@@ -181,4 +582,9 @@ int main(int argc, char** argv) {
 
 // Compilar: mpicxx -O3 -march=native -o ej4.out ej4.cpp
 // Ejecutar local: mpirun -n 4 ./ej4.out
-// Ejecutar en cluster: mpirun -n 8 --hostfile machinesfile.txt ./ej4.out
\ No newline at end of file
+// Algoritmo por filas (B replicada, una copia por nodo): mpirun -n 4 ./ej4.out --algoritmo=filas
+// Una copia de B por proceso: mpirun -n 4 ./ej4.out --algoritmo=filas --memoria-b=proceso
+// Matrices en archivos: mpirun -n 4 ./ej4.out --entrada-a=archivo:A.bin --entrada-b=fragmentos:B
+// Sin solapamiento / con C completa en el proceso 0: mpirun -n 4 ./ej4.out --comunicacion=bloqueante --recolectar
+// Hibrido (un proceso por nodo): mpirun -n 2 --map-by ppr:1:node --bind-to none ./ej4.out --hilos=8
+// Ejecutar en cluster: mpirun -n 8 --hostfile machinesfile.txt ./ej4.out
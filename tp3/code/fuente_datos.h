@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pool_hilos.h"
+
+// Fuentes de datos de entrada: cada proceso pide solo los bloques que le tocan
+// en lugar de que la raiz arme la matriz entera y la reparta. Un vector es una
+// matriz de 1 fila.
+//
+//   analitica              cada elemento es una funcion de su indice (i, j)
+//   archivo:RUTA           un archivo con la matriz completa (doubles crudos,
+//                          por filas), mapeado con mmap; todos los procesos de
+//                          un nodo comparten las paginas del archivo
+//   fragmentos:PREFIJO     el proceso r lee PREFIJO.r, que tiene solo su bloque:
+//                          cabecera de 4 uint64 (fila0, filas, col0, cols) y
+//                          despues filas x cols doubles por filas
+//
+// leer_bloque es const y sin estado mutable: se puede llamar desde varios hilos.
+class FuenteDatos {
+public:
+    virtual ~FuenteDatos() = default;
+
+    // Copia [fila0, fila0 + filas) x [col0, col0 + cols) en destino, por filas
+    // con paso cols. false si la fuente no tiene ese bloque.
+    virtual bool leer_bloque(size_t fila0, size_t filas, size_t col0, size_t cols, double* destino) const = 0;
+    virtual std::string descripcion() const = 0;
+};
+
+// valor(i, j) -> double
+template <class F>
+class FuenteAnalitica : public FuenteDatos {
+public:
+    explicit FuenteAnalitica(F valor) : valor_(std::move(valor)) {}
+
+    bool leer_bloque(size_t fila0, size_t filas, size_t col0, size_t cols, double* destino) const override {
+        for (size_t i = 0; i < filas; ++i)
+            for (size_t j = 0; j < cols; ++j) destino[i * cols + j] = valor_(fila0 + i, col0 + j);
+        return true;
+    }
+    std::string descripcion() const override { return "analitica"; }
+
+private:
+    F valor_;
+};
+
+template <class F>
+std::unique_ptr<FuenteDatos> fuente_analitica(F valor) {
+    return std::make_unique<FuenteAnalitica<F>>(std::move(valor));
+}
+
+// Archivo de solo lectura mapeado completo (MAP_SHARED: un proceso que lee una
+// parte no copia nada y los demas del nodo reusan las mismas paginas).
+class ArchivoMapeado {
+public:
+    ArchivoMapeado() = default;
+    ArchivoMapeado(const ArchivoMapeado&) = delete;
+    ArchivoMapeado& operator=(const ArchivoMapeado&) = delete;
+    ~ArchivoMapeado() {
+        if (mapa_) ::munmap(mapa_, tamanio_);
+    }
+
+    bool abrir(const std::string& ruta) {
+        int fd = ::open(ruta.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info{};
+        if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            void* p = ::mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) {
+                mapa_ = p;
+                tamanio_ = size_t(info.st_size);
+            }
+        }
+        ::close(fd);
+        return mapa_ != nullptr;
+    }
+
+    const char* datos() const { return static_cast<const char*>(mapa_); }
+    size_t tamanio() const { return tamanio_; }
+
+private:
+    void* mapa_ = nullptr;
+    size_t tamanio_ = 0;
+};
+
+class FuenteArchivo : public FuenteDatos {
+public:
+    FuenteArchivo(std::string ruta, size_t columnas) : ruta_(std::move(ruta)), columnas_(columnas) {}
+
+    // El archivo tiene que tener exactamente filas x columnas doubles.
+    bool abrir(size_t filas) {
+        return archivo_.abrir(ruta_) && archivo_.tamanio() == filas * columnas_ * sizeof(double);
+    }
+
+    bool leer_bloque(size_t fila0, size_t filas, size_t col0, size_t cols, double* destino) const override {
+        const double* matriz = reinterpret_cast<const double*>(archivo_.datos());
+        for (size_t i = 0; i < filas; ++i)
+            std::memcpy(destino + i * cols, matriz + (fila0 + i) * columnas_ + col0, cols * sizeof(double));
+        return true;
+    }
+    std::string descripcion() const override { return "archivo:" + ruta_; }
+
+private:
+    std::string ruta_;
+    size_t columnas_;
+    ArchivoMapeado archivo_;
+};
+
+class FuenteFragmentos : public FuenteDatos {
+public:
+    FuenteFragmentos(std::string prefijo, int rank) : ruta_(std::move(prefijo) + "." + std::to_string(rank)) {}
+
+    bool abrir() {
+        if (!archivo_.abrir(ruta_) || archivo_.tamanio() < sizeof(cabecera_)) return false;
+        std::memcpy(cabecera_, archivo_.datos(), sizeof(cabecera_));
+        return archivo_.tamanio() == sizeof(cabecera_) + cabecera_[1] * cabecera_[3] * sizeof(double);
+    }
+
+    // Solo puede dar bloques contenidos en el fragmento.
+    bool leer_bloque(size_t fila0, size_t filas, size_t col0, size_t cols, double* destino) const override {
+        const uint64_t f0 = cabecera_[0], nf = cabecera_[1], c0 = cabecera_[2], nc = cabecera_[3];
+        if (fila0 < f0 || fila0 + filas > f0 + nf || col0 < c0 || col0 + cols > c0 + nc) return false;
+        const double* bloque = reinterpret_cast<const double*>(archivo_.datos() + sizeof(cabecera_));
+        for (size_t i = 0; i < filas; ++i)
+            std::memcpy(destino + i * cols, bloque + (fila0 - f0 + i) * nc + (col0 - c0), cols * sizeof(double));
+        return true;
+    }
+    std::string descripcion() const override { return "fragmentos:" + ruta_; }
+
+private:
+    std::string ruta_;
+    uint64_t cabecera_[4] = {};
+    ArchivoMapeado archivo_;
+};
+
+// Crea la fuente descripta por `spec` ("analitica", "archivo:RUTA" o
+// "fragmentos:PREFIJO") para una matriz de filas x columnas. `analitica` es la
+// que se usa con "analitica". nullptr (con el motivo en cerr) si no se puede.
+inline std::unique_ptr<FuenteDatos> crear_fuente(const std::string& spec, size_t filas, size_t columnas, int rank,
+                                                 std::unique_ptr<FuenteDatos> analitica) {
+    if (spec == "analitica") return analitica;
+    if (spec.rfind("archivo:", 0) == 0) {
+        auto fuente = std::make_unique<FuenteArchivo>(spec.substr(8), columnas);
+        if (fuente->abrir(filas)) return fuente;
+        std::cerr << "Proceso " << rank << ": no se pudo mapear " << spec.substr(8) << " como matriz de "
+                  << filas << " x " << columnas << " doubles" << std::endl;
+        return nullptr;
+    }
+    if (spec.rfind("fragmentos:", 0) == 0) {
+        auto fuente = std::make_unique<FuenteFragmentos>(spec.substr(11), rank);
+        if (fuente->abrir()) return fuente;
+        std::cerr << "Proceso " << rank << ": fragmento invalido o inexistente: " << fuente->descripcion() << std::endl;
+        return nullptr;
+    }
+    std::cerr << "Fuente desconocida: " << spec << " (analitica|archivo:RUTA|fragmentos:PREFIJO)" << std::endl;
+    return nullptr;
+}
+
+// leer_bloque repartido entre los hilos del pool: por filas o, si es una sola
+// fila (un vector), por tramos de columnas.
+inline bool leer_bloque_paralelo(PoolHilos& pool, const FuenteDatos& fuente, size_t fila0, size_t filas,
+                                 size_t col0, size_t cols, double* destino) {
+    std::atomic<bool> ok{true};
+    const size_t trozos = 4 * pool.cantidad_hilos();
+    if (filas == 1) {
+        pool.parallel_for(0, cols, std::max<size_t>(4096, cols / trozos), [&](size_t a, size_t b) {
+            if (!fuente.leer_bloque(fila0, 1, col0 + a, b - a, destino + a)) ok = false;
+        });
+    } else {
+        pool.parallel_for(0, filas, std::max<size_t>(1, filas / trozos), [&](size_t a, size_t b) {
+            if (!fuente.leer_bloque(fila0 + a, b - a, col0, cols, destino + a * cols)) ok = false;
+        });
+    }
+    return ok;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+#include "pool_hilos.h"
+
+// Modo hibrido MPI + hilos: en lugar de un proceso MPI por nucleo se lanza uno
+// por nodo (o por socket) y cada proceso reparte su trabajo entre un pool de
+// hilos. Asi los datos que todos necesitan (el texto de ej2, la matriz B de
+// ej4) se cargan una vez por nodo y no una vez por nucleo, y los colectivos
+// tienen menos participantes.
+//
+// Solo el hilo principal llama a MPI (MPI_THREAD_FUNNELED): los hilos del pool
+// unicamente calculan, y la comunicacion se hace antes o despues de cada
+// parallel_for.
+//
+//   mpirun -n <nodos>   --map-by ppr:1:node   --bind-to none   ./ejN
+//   mpirun -n <sockets> --map-by ppr:1:socket --bind-to socket ./ejN
+
+// Inicializa MPI y devuelve cuantos hilos usar por proceso: --hilos=N si se
+// paso; si no, los nucleos del nodo divididos por los procesos que comparten
+// ese nodo (con un proceso por nucleo, como antes, queda en 1). Si la
+// implementacion no da MPI_THREAD_FUNNELED, un hilo.
+inline unsigned iniciar_mpi_hibrido(int* argc, char*** argv) {
+    int provisto = MPI_THREAD_SINGLE;
+    MPI_Init_thread(argc, argv, MPI_THREAD_FUNNELED, &provisto);
+
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    if (provisto < MPI_THREAD_FUNNELED) {
+        if (rank == 0) std::cerr << "Aviso: MPI no soporta MPI_THREAD_FUNNELED, se usa un hilo por proceso\n";
+        return 1;
+    }
+
+    unsigned pedidos = PoolHilos::hilos_desde_argumentos(*argc, *argv);
+    if (pedidos > 0) return pedidos;
+
+    MPI_Comm nodo;
+    int procesos_en_nodo = 1;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &nodo);
+    MPI_Comm_size(nodo, &procesos_en_nodo);
+    MPI_Comm_free(&nodo);
+    unsigned nucleos = std::max(1u, std::thread::hardware_concurrency());
+    return std::max(1u, nucleos / unsigned(procesos_en_nodo));
+}
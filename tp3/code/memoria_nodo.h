@@ -0,0 +1,92 @@
+#pragma once
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cstddef>
+
+// Memoria compartida por los procesos de un nodo, para datos de solo lectura
+// que todos necesitan completos (el texto de ej2, la matriz B de ej4 por filas).
+// En lugar de una copia por proceso hay una por nodo: la reserva el lider del
+// nodo con MPI_Win_allocate_shared y los demas la leen en el lugar, con el
+// puntero que da MPI_Win_shared_query.
+//
+//   comm_nodo      procesos del mismo nodo (MPI_Comm_split_type SHARED); el
+//                  lider es el de menor rank
+//   comm_lideres   un proceso por nodo (MPI_COMM_NULL en los que no son lider);
+//                  el rank 0 de `comm` es lider y tiene rank 0 aca
+//
+// Para llenarla: escribe quien tenga los datos (el lider, o cada proceso del
+// nodo una parte), difundir_entre_nodos() los manda solo a los lideres y
+// sincronizar() los deja visibles para todo el nodo.
+class MemoriaNodo {
+public:
+    MemoriaNodo(size_t bytes, MPI_Comm comm = MPI_COMM_WORLD) : bytes_(bytes) {
+        int rank = 0;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &comm_nodo_);
+        MPI_Comm_rank(comm_nodo_, &rank_nodo_);
+        MPI_Comm_size(comm_nodo_, &procesos_nodo_);
+        MPI_Comm_split(comm, lider() ? 0 : MPI_UNDEFINED, rank, &comm_lideres_);
+
+        void* base = nullptr;
+        MPI_Win_allocate_shared(lider() ? MPI_Aint(bytes) : 0, 1, MPI_INFO_NULL, comm_nodo_, &base, &ventana_);
+        MPI_Aint tamanio = 0;
+        int unidad = 1;
+        MPI_Win_shared_query(ventana_, 0, &tamanio, &unidad, &base);
+        datos_ = static_cast<char*>(base);
+        MPI_Win_lock_all(MPI_MODE_NOCHECK, ventana_); // acceso pasivo durante toda la vida de la ventana
+    }
+
+    MemoriaNodo(const MemoriaNodo&) = delete;
+    MemoriaNodo& operator=(const MemoriaNodo&) = delete;
+
+    ~MemoriaNodo() {
+        MPI_Win_unlock_all(ventana_);
+        MPI_Win_free(&ventana_);
+        if (comm_lideres_ != MPI_COMM_NULL) MPI_Comm_free(&comm_lideres_);
+        MPI_Comm_free(&comm_nodo_);
+    }
+
+    char* datos() const { return datos_; }
+    size_t bytes() const { return bytes_; }
+    bool lider() const { return rank_nodo_ == 0; }
+    int rank_nodo() const { return rank_nodo_; }
+    int procesos_nodo() const { return procesos_nodo_; }
+    MPI_Comm comm_nodo() const { return comm_nodo_; }
+    MPI_Comm comm_lideres() const { return comm_lideres_; }
+
+    // Lo escrito hasta aca por cualquier proceso del nodo queda visible para los demas.
+    void sincronizar() {
+        MPI_Win_sync(ventana_);
+        MPI_Barrier(comm_nodo_);
+        MPI_Win_sync(ventana_);
+    }
+
+    // [desde, desde + cantidad) del lider de la raiz (rank 0 de comm) a los demas
+    // lideres, en tandas de a lo sumo 1 GiB (la cantidad de MPI_Bcast es int).
+    // Colectiva sobre comm; no sincroniza.
+    void difundir_entre_nodos(size_t desde = 0, size_t cantidad = size_t(-1)) {
+        cantidad = std::min(cantidad, bytes_ - desde);
+        if (comm_lideres_ == MPI_COMM_NULL) return;
+        const size_t TANDA = size_t(1) << 30;
+        for (size_t hecho = 0; hecho < cantidad; hecho += TANDA)
+            MPI_Bcast(datos_ + desde + hecho, (int)std::min(TANDA, cantidad - hecho), MPI_BYTE, 0, comm_lideres_);
+    }
+
+    // Igual, no bloqueante (un solo pedido; cantidad < 2 GiB). En los que no son
+    // lider el pedido queda en MPI_REQUEST_NULL.
+    MPI_Request difundir_entre_nodos_async(size_t desde, size_t cantidad) {
+        MPI_Request pedido = MPI_REQUEST_NULL;
+        if (comm_lideres_ != MPI_COMM_NULL)
+            MPI_Ibcast(datos_ + desde, (int)cantidad, MPI_BYTE, 0, comm_lideres_, &pedido);
+        return pedido;
+    }
+
+private:
+    size_t bytes_;
+    MPI_Comm comm_nodo_ = MPI_COMM_NULL, comm_lideres_ = MPI_COMM_NULL;
+    int rank_nodo_ = 0, procesos_nodo_ = 1;
+    MPI_Win ventana_ = MPI_WIN_NULL;
+    char* datos_ = nullptr;
+};
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+#include <immintrin.h>
+
+// Kernels del producto escalar de un bloque, con dos caminos:
+//
+//  - arreglos: sum a[i] * b[i] sobre datos en memoria. Con `sin_cache` se
+//    adelanta la lectura con prefetch NTA: los datos se leen una sola vez, asi
+//    que no tiene sentido que desalojen la cache (en memoria normal, write-back,
+//    las cargas "streaming" de x86 se comportan como cargas comunes; el aviso
+//    no temporal efectivo es el del prefetch).
+//  - afin (fusionado): las entradas son progresiones aritmeticas
+//    x_j = base + paso * j, y los terminos se generan en registros al vuelo, sin
+//    arreglos: ni memoria ni trafico de memoria, el bloque queda limitado por el
+//    computo.
+//
+// Ambos dan un Parcial {suma, compensacion}. La variante compensada lleva el
+// error de redondeo de cada suma por separado (TwoSum de Knuth), con la misma
+// semantica que SumaKahan de reduccion.h (valor = suma + compensacion); la
+// directa deja compensacion en 0.
+//
+// Las versiones SIMD reparten los terminos en carriles x 4 acumuladores
+// independientes (sin dependencias entre iteraciones salvo la de cada
+// acumulador) y los combinan al final en un orden fijo, asi que el resultado de
+// un bloque solo depende del kernel, no de los hilos ni de los procesos.
+//
+// La variante se elige en tiempo de ejecucion segun la CPU
+// (AVX-512 -> AVX2 -> escalar), o por nombre.
+
+namespace producto_punto {
+
+struct Parcial {
+    double suma = 0.0;
+    double compensacion = 0.0;
+
+    // TwoSum: suma + x == nueva suma + error, exacto
+    void agregar_compensado(double x) {
+        double t = suma + x;
+        double bv = t - suma;
+        compensacion += (suma - (t - bv)) + (x - bv);
+        suma = t;
+    }
+    double valor() const { return suma + compensacion; }
+};
+
+// x_j = base + paso * j (exacto mientras los valores sean enteros < 2^53)
+struct Afin {
+    double base = 0.0, paso = 1.0;
+    double en(long long j) const { return base + paso * double(j); }
+};
+
+// ---------------------- Escalar ----------------------
+
+template <bool Compensado>
+inline Parcial arreglos_escalar(const double* a, const double* b, size_t n, bool) {
+    Parcial p;
+    for (size_t i = 0; i < n; ++i) {
+        if constexpr (Compensado) p.agregar_compensado(a[i] * b[i]);
+        else p.suma += a[i] * b[i];
+    }
+    return p;
+}
+
+template <bool Compensado>
+inline Parcial afin_escalar(Afin a, Afin b, long long ini, long long fin) {
+    Parcial p;
+    for (long long j = ini; j < fin; ++j) {
+        if constexpr (Compensado) p.agregar_compensado(a.en(j) * b.en(j));
+        else p.suma += a.en(j) * b.en(j);
+    }
+    return p;
+}
+
+// Combina los acumuladores de los carriles en orden fijo.
+template <bool Compensado>
+inline Parcial combinar_carriles(const double* sumas, const double* compensaciones, int cantidad) {
+    Parcial p;
+    for (int i = 0; i < cantidad; ++i) {
+        if constexpr (Compensado) {
+            p.agregar_compensado(sumas[i]);
+            p.compensacion += compensaciones[i];
+        } else {
+            p.suma += sumas[i];
+        }
+    }
+    return p;
+}
+
+template <bool Compensado>
+inline void sumar_cola(Parcial& p, const Parcial& cola) {
+    if constexpr (Compensado) {
+        p.agregar_compensado(cola.suma);
+        p.compensacion += cola.compensacion;
+    } else {
+        p.suma += cola.suma;
+    }
+}
+
+constexpr size_t DISTANCIA_PREFETCH = 512; // doubles por delante (4 KiB)
+
+// ---------------------- AVX2 ----------------------
+
+template <bool Compensado>
+__attribute__((target("avx2,fma")))
+inline void acumular_avx2(__m256d& s, __m256d& c, __m256d x, __m256d y) {
+    if constexpr (Compensado) {
+        __m256d prod = _mm256_mul_pd(x, y);
+        __m256d t = _mm256_add_pd(s, prod);
+        __m256d bv = _mm256_sub_pd(t, s);
+        c = _mm256_add_pd(c, _mm256_add_pd(_mm256_sub_pd(s, _mm256_sub_pd(t, bv)), _mm256_sub_pd(prod, bv)));
+        s = t;
+    } else {
+        s = _mm256_fmadd_pd(x, y, s);
+    }
+}
+
+template <bool Compensado>
+__attribute__((target("avx2,fma")))
+inline Parcial arreglos_avx2(const double* a, const double* b, size_t n, bool sin_cache) {
+    constexpr size_t L = 4, A = 4, S = L * A;
+    __m256d s[A], c[A];
+    for (size_t k = 0; k < A; ++k) s[k] = c[k] = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + S <= n; i += S) {
+        if (sin_cache) {
+            _mm_prefetch((const char*)(a + i + DISTANCIA_PREFETCH), _MM_HINT_NTA);
+            _mm_prefetch((const char*)(b + i + DISTANCIA_PREFETCH), _MM_HINT_NTA);
+            _mm_prefetch((const char*)(a + i + DISTANCIA_PREFETCH + 8), _MM_HINT_NTA);
+            _mm_prefetch((const char*)(b + i + DISTANCIA_PREFETCH + 8), _MM_HINT_NTA);
+        }
+        for (size_t k = 0; k < A; ++k)
+            acumular_avx2<Compensado>(s[k], c[k], _mm256_loadu_pd(a + i + k * L), _mm256_loadu_pd(b + i + k * L));
+    }
+
+    double sumas[S], compensaciones[S];
+    for (size_t k = 0; k < A; ++k) {
+        _mm256_storeu_pd(sumas + k * L, s[k]);
+        _mm256_storeu_pd(compensaciones + k * L, c[k]);
+    }
+    Parcial p = combinar_carriles<Compensado>(sumas, compensaciones, S);
+    sumar_cola<Compensado>(p, arreglos_escalar<Compensado>(a + i, b + i, n - i, false));
+    return p;
+}
+
+template <bool Compensado>
+__attribute__((target("avx2,fma")))
+inline Parcial afin_avx2(Afin a, Afin b, long long ini, long long fin) {
+    constexpr int L = 4, A = 4, S = L * A;
+    if (fin - ini < S) return afin_escalar<Compensado>(a, b, ini, fin);
+
+    __m256d s[A], c[A], j[A];
+    for (int k = 0; k < A; ++k) {
+        s[k] = c[k] = _mm256_setzero_pd();
+        double base = double(ini + k * L);
+        j[k] = _mm256_setr_pd(base, base + 1, base + 2, base + 3);
+    }
+    const __m256d base_a = _mm256_set1_pd(a.base), paso_a = _mm256_set1_pd(a.paso);
+    const __m256d base_b = _mm256_set1_pd(b.base), paso_b = _mm256_set1_pd(b.paso);
+    const __m256d avance = _mm256_set1_pd(double(S));
+
+    long long n = ini;
+    for (; n + S <= fin; n += S) {
+        for (int k = 0; k < A; ++k) {
+            acumular_avx2<Compensado>(s[k], c[k], _mm256_fmadd_pd(paso_a, j[k], base_a), _mm256_fmadd_pd(paso_b, j[k], base_b));
+            j[k] = _mm256_add_pd(j[k], avance);
+        }
+    }
+
+    double sumas[S], compensaciones[S];
+    for (int k = 0; k < A; ++k) {
+        _mm256_storeu_pd(sumas + k * L, s[k]);
+        _mm256_storeu_pd(compensaciones + k * L, c[k]);
+    }
+    Parcial p = combinar_carriles<Compensado>(sumas, compensaciones, S);
+    sumar_cola<Compensado>(p, afin_escalar<Compensado>(a, b, n, fin));
+    return p;
+}
+
+// ---------------------- AVX-512 ----------------------
+
+template <bool Compensado>
+__attribute__((target("avx512f")))
+inline void acumular_avx512(__m512d& s, __m512d& c, __m512d x, __m512d y) {
+    if constexpr (Compensado) {
+        __m512d prod = _mm512_mul_pd(x, y);
+        __m512d t = _mm512_add_pd(s, prod);
+        __m512d bv = _mm512_sub_pd(t, s);
+        c = _mm512_add_pd(c, _mm512_add_pd(_mm512_sub_pd(s, _mm512_sub_pd(t, bv)), _mm512_sub_pd(prod, bv)));
+        s = t;
+    } else {
+        s = _mm512_fmadd_pd(x, y, s);
+    }
+}
+
+template <bool Compensado>
+__attribute__((target("avx512f")))
+inline Parcial arreglos_avx512(const double* a, const double* b, size_t n, bool sin_cache) {
+    constexpr size_t L = 8, A = 4, S = L * A;
+    __m512d s[A], c[A];
+    for (size_t k = 0; k < A; ++k) s[k] = c[k] = _mm512_setzero_pd();
+
+    size_t i = 0;
+    for (; i + S <= n; i += S) {
+        if (sin_cache) {
+            for (size_t linea = 0; linea < S; linea += 8) {
+                _mm_prefetch((const char*)(a + i + DISTANCIA_PREFETCH + linea), _MM_HINT_NTA);
+                _mm_prefetch((const char*)(b + i + DISTANCIA_PREFETCH + linea), _MM_HINT_NTA);
+            }
+        }
+        for (size_t k = 0; k < A; ++k)
+            acumular_avx512<Compensado>(s[k], c[k], _mm512_loadu_pd(a + i + k * L), _mm512_loadu_pd(b + i + k * L));
+    }
+
+    double sumas[S], compensaciones[S];
+    for (size_t k = 0; k < A; ++k) {
+        _mm512_storeu_pd(sumas + k * L, s[k]);
+        _mm512_storeu_pd(compensaciones + k * L, c[k]);
+    }
+    Parcial p = combinar_carriles<Compensado>(sumas, compensaciones, S);
+    sumar_cola<Compensado>(p, arreglos_escalar<Compensado>(a + i, b + i, n - i, false));
+    return p;
+}
+
+template <bool Compensado>
+__attribute__((target("avx512f")))
+inline Parcial afin_avx512(Afin a, Afin b, long long ini, long long fin) {
+    constexpr int L = 8, A = 4, S = L * A;
+    if (fin - ini < S) return afin_escalar<Compensado>(a, b, ini, fin);
+
+    __m512d s[A], c[A], j[A];
+    const __m512d iota = _mm512_setr_pd(0, 1, 2, 3, 4, 5, 6, 7);
+    for (int k = 0; k < A; ++k) {
+        s[k] = c[k] = _mm512_setzero_pd();
+        j[k] = _mm512_add_pd(_mm512_set1_pd(double(ini + k * L)), iota);
+    }
+    const __m512d base_a = _mm512_set1_pd(a.base), paso_a = _mm512_set1_pd(a.paso);
+    const __m512d base_b = _mm512_set1_pd(b.base), paso_b = _mm512_set1_pd(b.paso);
+    const __m512d avance = _mm512_set1_pd(double(S));
+
+    long long n = ini;
+    for (; n + S <= fin; n += S) {
+        for (int k = 0; k < A; ++k) {
+            acumular_avx512<Compensado>(s[k], c[k], _mm512_fmadd_pd(paso_a, j[k], base_a), _mm512_fmadd_pd(paso_b, j[k], base_b));
+            j[k] = _mm512_add_pd(j[k], avance);
+        }
+    }
+
+    double sumas[S], compensaciones[S];
+    for (int k = 0; k < A; ++k) {
+        _mm512_storeu_pd(sumas + k * L, s[k]);
+        _mm512_storeu_pd(compensaciones + k * L, c[k]);
+    }
+    Parcial p = combinar_carriles<Compensado>(sumas, compensaciones, S);
+    sumar_cola<Compensado>(p, afin_escalar<Compensado>(a, b, n, fin));
+    return p;
+}
+
+// ---------------------- Seleccion ----------------------
+
+struct Kernel {
+    const char* nombre;
+    Parcial (*arreglos)(const double*, const double*, size_t, bool);
+    Parcial (*arreglos_compensado)(const double*, const double*, size_t, bool);
+    Parcial (*afin)(Afin, Afin, long long, long long);
+    Parcial (*afin_compensado)(Afin, Afin, long long, long long);
+};
+
+// nombre: "avx512", "avx2", "escalar" o nullptr/"auto" para el mejor disponible.
+// Un kernel pedido que la CPU no soporta cae al siguiente disponible.
+inline Kernel elegir_kernel(const char* nombre = nullptr) {
+    static const Kernel escalar{"escalar", arreglos_escalar<false>, arreglos_escalar<true>, afin_escalar<false>, afin_escalar<true>};
+    static const Kernel avx2{"avx2", arreglos_avx2<false>, arreglos_avx2<true>, afin_avx2<false>, afin_avx2<true>};
+    static const Kernel avx512{"avx512", arreglos_avx512<false>, arreglos_avx512<true>, afin_avx512<false>, afin_avx512<true>};
+
+    __builtin_cpu_init();
+    const bool automatico = nombre == nullptr || std::strcmp(nombre, "auto") == 0;
+    if (!automatico && std::strcmp(nombre, "escalar") == 0) return escalar;
+    if ((automatico || std::strcmp(nombre, "avx512") == 0) && __builtin_cpu_supports("avx512f")) return avx512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return avx2;
+    return escalar;
+}
+
+} // namespace producto_punto
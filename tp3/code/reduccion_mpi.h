@@ -0,0 +1,64 @@
+#pragma once
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include "reduccion.h"
+
+// Reduccion MPI reproducible: el dominio se parte en bloques de tamanio FIJO
+// (no depende de la cantidad de procesos), cada proceso toma un rango contiguo
+// de bloques y calcula un parcial por bloque con la politica de suma elegida.
+// La raiz junta todos los parciales y los combina en orden de bloque, asi que
+// el resultado es el mismo con 1 o con N procesos. (MPI_Reduce no sirve: el
+// orden y la forma del arbol de reduccion dependen de la implementacion y de
+// la cantidad de procesos.)
+
+struct RangoBloques {
+    long long primer_bloque = 0, fin_bloque = 0; // [primer_bloque, fin_bloque)
+    long long inicio = 0, fin = 0;               // elementos [inicio, fin)
+};
+
+inline RangoBloques repartir_bloques(long long elementos, long long tam_bloque, int rank, int size) {
+    long long bloques = (elementos + tam_bloque - 1) / tam_bloque;
+    long long base = bloques / size, resto = bloques % size;
+    RangoBloques r;
+    r.primer_bloque = rank * base + std::min<long long>(rank, resto);
+    r.fin_bloque = r.primer_bloque + base + (rank < resto ? 1 : 0);
+    r.inicio = std::min(elementos, r.primer_bloque * tam_bloque);
+    r.fin = std::min(elementos, r.fin_bloque * tam_bloque);
+    return r;
+}
+
+// Junta en `raiz` los parciales por bloque de todos los procesos (en orden de
+// rank, que es orden de bloque) y los combina. Las politicas son tipos
+// triviales, asi que viajan como bytes. Fuera de la raiz devuelve un acumulador vacio.
+template <class Politica>
+Politica combinar_bloques_en_orden(const std::vector<Politica>& locales, int raiz, MPI_Comm comm) {
+    static_assert(std::is_trivially_copyable<Politica>::value, "la politica debe poder copiarse byte a byte");
+    int rank = 0, size = 1;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    int bytes_locales = int(locales.size() * sizeof(Politica));
+    std::vector<int> bytes(size), desplazamientos(size);
+    MPI_Gather(&bytes_locales, 1, MPI_INT, bytes.data(), 1, MPI_INT, raiz, comm);
+
+    std::vector<Politica> todos;
+    if (rank == raiz) {
+        int total = 0;
+        for (int p = 0; p < size; ++p) {
+            desplazamientos[p] = total;
+            total += bytes[p];
+        }
+        todos.resize(size_t(total) / sizeof(Politica));
+    }
+    MPI_Gatherv(locales.data(), bytes_locales, MPI_BYTE, todos.data(), bytes.data(), desplazamientos.data(),
+                MPI_BYTE, raiz, comm);
+
+    Politica total;
+    for (const Politica& parcial : todos) total.combinar(parcial);
+    return total;
+}
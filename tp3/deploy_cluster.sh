@@ -81,10 +81,10 @@ compilar_remoto() {
     for host in "${HOSTS[@]}"; do
         echo "  Compilando en $host..."
         ssh "$USUARIO@$host" "cd $REMOTE_DIR/code && \
-                   mpic++ -o ej1_mpi ej1.cpp -std=c++11 && \
-                   mpic++ -o ej2_mpi ej2.cpp -std=c++11 && \
-                   mpic++ -o ej3_mpi ej3.cpp -std=c++11 && \
-                   mpic++ -o ej4_mpi ej4.cpp -std=c++11" &
+                   mpic++ -o ej1_mpi ej1.cpp -std=c++17 && \
+                   mpic++ -o ej2_mpi ej2.cpp -std=c++17 && \
+                   mpic++ -o ej3_mpi ej3.cpp -std=c++17 && \
+                   mpic++ -o ej4_mpi ej4.cpp -std=c++17" &
     done
     wait
     echo "✓ Compilación completada en todos los hosts"
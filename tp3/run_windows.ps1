@@ -17,10 +17,10 @@ Write-Host "Compilando ejercicios en WSL..." -ForegroundColor Green
 Write-Host ""
 
 # Compilar todos los ejercicios
-wsl bash -c "cd code && mpic++ -o ej1_mpi ej1.cpp -std=c++11 && echo '✓ Ejercicio 1 compilado'"
-wsl bash -c "cd code && mpic++ -o ej2_mpi ej2.cpp -std=c++11 && echo '✓ Ejercicio 2 compilado'"
-wsl bash -c "cd code && mpic++ -o ej3_mpi ej3.cpp -std=c++11 && echo '✓ Ejercicio 3 compilado'"
-wsl bash -c "cd code && mpic++ -o ej4_mpi ej4.cpp -std=c++11 && echo '✓ Ejercicio 4 compilado'"
+wsl bash -c "cd code && mpic++ -o ej1_mpi ej1.cpp -std=c++17 && echo '✓ Ejercicio 1 compilado'"
+wsl bash -c "cd code && mpic++ -o ej2_mpi ej2.cpp -std=c++17 && echo '✓ Ejercicio 2 compilado'"
+wsl bash -c "cd code && mpic++ -o ej3_mpi ej3.cpp -std=c++17 && echo '✓ Ejercicio 3 compilado'"
+wsl bash -c "cd code && mpic++ -o ej4_mpi ej4.cpp -std=c++17 && echo '✓ Ejercicio 4 compilado'"
 
 Write-Host ""
 Write-Host "================================================" -ForegroundColor Cyan